@@ -793,6 +793,7 @@ FLASH_SIZES = [
 CONF_FLASH_SIZE = "flash_size"
 CONF_CPU_FREQUENCY = "cpu_frequency"
 CONF_PARTITIONS = "partitions"
+CONF_NVS_MIN_WRITE_INTERVAL = "nvs_min_write_interval"
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
@@ -806,6 +807,9 @@ CONFIG_SCHEMA = cv.All(
             cv.Optional(CONF_PARTITIONS): cv.file_,
             cv.Optional(CONF_VARIANT): cv.one_of(*VARIANTS, upper=True),
             cv.Optional(CONF_FRAMEWORK): FRAMEWORK_SCHEMA,
+            cv.Optional(
+                CONF_NVS_MIN_WRITE_INTERVAL, default="0s"
+            ): cv.positive_time_period_milliseconds,
         }
     ),
     _detect_variant,
@@ -828,6 +832,11 @@ async def to_code(config):
     cg.add_build_flag(f"-DUSE_ESP32_VARIANT_{variant}")
     cg.add_define("ESPHOME_VARIANT", VARIANT_FRIENDLY[variant])
     cg.add_define(ThreadModel.MULTI_ATOMICS)
+    if config[CONF_NVS_MIN_WRITE_INTERVAL].total_milliseconds > 0:
+        cg.add_define(
+            "USE_ESP32_NVS_MIN_WRITE_INTERVAL",
+            config[CONF_NVS_MIN_WRITE_INTERVAL].total_milliseconds,
+        )
 
     cg.add_platformio_option("lib_ldf_mode", "off")
     cg.add_platformio_option("lib_compat_mode", "strict")
@@ -1,14 +1,22 @@
 #ifdef USE_ESP32
 
+#include "preferences.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
 #include "esphome/core/preferences.h"
+#include <esp_system.h>
 #include <nvs_flash.h>
 #include <cstring>
 #include <cinttypes>
 #include <vector>
 #include <string>
 
+#ifndef USE_ESP32_NVS_MIN_WRITE_INTERVAL
+#define USE_ESP32_NVS_MIN_WRITE_INTERVAL 0
+#endif
+
 namespace esphome {
 namespace esp32 {
 
@@ -17,15 +25,77 @@ static const char *const TAG = "esp32.preferences";
 struct NVSData {
   std::string key;
   std::vector<uint8_t> data;
+  bool deferred = false;  // counted in NVSStats::deferred already
 };
 
 static std::vector<NVSData> s_pending_save;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
 
+// What is known to be stored in NVS for a key, so unchanged data can be
+// skipped without reading the blob back from flash.
+struct NVSShadow {
+  std::string key;
+  uint64_t hash;
+  size_t len;
+  uint32_t last_write;
+};
+
+static std::vector<NVSShadow> s_shadow;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+static NVSStats s_stats{};               // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+const NVSStats &get_nvs_stats() { return s_stats; }
+
+static uint64_t shadow_hash(const uint8_t *data, size_t len) {
+  // 64 bit FNV-1a, a collision would make a changed blob look unchanged.
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (size_t i = 0; i < len; i++) {
+    hash ^= data[i];
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+static NVSShadow *find_shadow(const std::string &key) {
+  for (auto &shadow : s_shadow) {
+    if (shadow.key == key)
+      return &shadow;
+  }
+  return nullptr;
+}
+
+static void store_shadow(const NVSShadow &update) {
+  NVSShadow *shadow = find_shadow(update.key);
+  if (shadow == nullptr) {
+    s_shadow.push_back(update);
+    return;
+  }
+  *shadow = update;
+}
+
+static void set_shadow(const std::string &key, const uint8_t *data, size_t len, uint32_t last_write) {
+  store_shadow(NVSShadow{key, shadow_hash(data, len), len, last_write});
+}
+
+static bool matches_shadow(const std::string &key, const uint8_t *data, size_t len) {
+  const NVSShadow *shadow = find_shadow(key);
+  return shadow != nullptr && shadow->len == len && shadow->hash == shadow_hash(data, len);
+}
+
 class ESP32PreferenceBackend : public ESPPreferenceBackend {
  public:
   std::string key;
   uint32_t nvs_handle;
   bool save(const uint8_t *data, size_t len) override {
+    // data that is already stored needs no write, drop any pending one
+    if (matches_shadow(key, data, len)) {
+      for (auto it = s_pending_save.begin(); it != s_pending_save.end(); ++it) {
+        if (it->key == key) {
+          s_pending_save.erase(it);
+          break;
+        }
+      }
+      s_stats.skipped++;
+      return true;
+    }
     // try find in pending saves and update that
     for (auto &obj : s_pending_save) {
       if (obj.key == key) {
@@ -54,6 +124,7 @@ class ESP32PreferenceBackend : public ESPPreferenceBackend {
     }
 
     size_t actual_len;
+    s_stats.reads++;
     esp_err_t err = nvs_get_blob(nvs_handle, key.c_str(), nullptr, &actual_len);
     if (err != 0) {
       ESP_LOGV(TAG, "nvs_get_blob('%s'): %s - the key might not be set yet", key.c_str(), esp_err_to_name(err));
@@ -63,6 +134,7 @@ class ESP32PreferenceBackend : public ESPPreferenceBackend {
       ESP_LOGVV(TAG, "NVS length does not match (%u!=%u)", actual_len, len);
       return false;
     }
+    s_stats.reads++;
     err = nvs_get_blob(nvs_handle, key.c_str(), data, &len);
     if (err != 0) {
       ESP_LOGV(TAG, "nvs_get_blob('%s') failed: %s", key.c_str(), esp_err_to_name(err));
@@ -70,6 +142,8 @@ class ESP32PreferenceBackend : public ESPPreferenceBackend {
     } else {
       ESP_LOGVV(TAG, "nvs_get_blob: key: %s, len: %d", key.c_str(), len);
     }
+    // not written by us, so it does not count against the write interval
+    set_shadow(key, data, len, millis() - USE_ESP32_NVS_MIN_WRITE_INTERVAL);
     return true;
   }
 };
@@ -107,19 +181,36 @@ class ESP32Preferences : public ESPPreferences {
     return ESPPreferenceObject(pref);
   }
 
-  bool sync() override {
+  bool sync() override { return this->write_pending(false); }
+
+  /// Write the pending saves to NVS. Saves postponed by the minimum write
+  /// interval are kept pending unless `force` is set.
+  bool write_pending(bool force) {
     if (s_pending_save.empty())
       return true;
 
     ESP_LOGV(TAG, "Saving %d items...", s_pending_save.size());
     // goal try write all pending saves even if one fails
-    int cached = 0, written = 0, failed = 0;
+    int cached = 0, written = 0, deferred = 0, failed = 0;
+    uint32_t now = millis();
     esp_err_t last_err = ESP_OK;
     std::string last_key{};
+    // only known to be stored once the commit succeeded
+    std::vector<NVSShadow> written_shadows;
 
     // go through vector from back to front (makes erase easier/more efficient)
     for (ssize_t i = s_pending_save.size() - 1; i >= 0; i--) {
-      const auto &save = s_pending_save[i];
+      auto &save = s_pending_save[i];
+      const NVSShadow *shadow = find_shadow(save.key);
+      if (!force && shadow != nullptr && now - shadow->last_write < USE_ESP32_NVS_MIN_WRITE_INTERVAL) {
+        // written recently, keep it pending to coalesce with later saves
+        if (!save.deferred) {
+          save.deferred = true;
+          s_stats.deferred++;
+        }
+        deferred++;
+        continue;
+      }
       ESP_LOGVV(TAG, "Checking if NVS data %s has changed", save.key.c_str());
       if (is_changed(nvs_handle, save)) {
         esp_err_t err = nvs_set_blob(nvs_handle, save.key.c_str(), save.data.data(), save.data.size());
@@ -132,15 +223,23 @@ class ESP32Preferences : public ESPPreferences {
           last_key = save.key;
           continue;
         }
+        s_stats.writes++;
+        s_stats.bytes_written += save.data.size();
+        written_shadows.push_back(
+            NVSShadow{save.key, shadow_hash(save.data.data(), save.data.size()), save.data.size(), now});
         written++;
       } else {
         ESP_LOGV(TAG, "NVS data not changed skipping %s  len=%u", save.key.c_str(), save.data.size());
+        if (shadow == nullptr)
+          set_shadow(save.key, save.data.data(), save.data.size(), now - USE_ESP32_NVS_MIN_WRITE_INTERVAL);
         cached++;
       }
       s_pending_save.erase(s_pending_save.begin() + i);
     }
-    ESP_LOGD(TAG, "Writing %d items: %d cached, %d written, %d failed", cached + written + failed, cached, written,
-             failed);
+    ESP_LOGD(TAG, "Writing %d items: %d cached, %d written, %d deferred, %d failed",
+             cached + written + deferred + failed, cached, written, deferred, failed);
+    ESP_LOGV(TAG, "NVS totals: %" PRIu32 " reads, %" PRIu32 " writes, %" PRIu32 " bytes written, %" PRIu32 " skipped",
+             s_stats.reads, s_stats.writes, s_stats.bytes_written, s_stats.skipped);
     if (failed > 0) {
       ESP_LOGE(TAG, "Writing %d items failed. Last error=%s for key=%s", failed, esp_err_to_name(last_err),
                last_key.c_str());
@@ -152,18 +251,27 @@ class ESP32Preferences : public ESPPreferences {
       ESP_LOGV(TAG, "nvs_commit() failed: %s", esp_err_to_name(err));
       return false;
     }
+    for (const auto &shadow : written_shadows)
+      store_shadow(shadow);
 
     return failed == 0;
   }
   bool is_changed(const uint32_t nvs_handle, const NVSData &to_save) {
+    // the shadow answers without touching flash once the key has been seen
+    const NVSShadow *shadow = find_shadow(to_save.key);
+    if (shadow != nullptr)
+      return shadow->len != to_save.data.size() || shadow->hash != shadow_hash(to_save.data.data(), to_save.data.size());
+
     NVSData stored_data{};
     size_t actual_len;
+    s_stats.reads++;
     esp_err_t err = nvs_get_blob(nvs_handle, to_save.key.c_str(), nullptr, &actual_len);
     if (err != 0) {
       ESP_LOGV(TAG, "nvs_get_blob('%s'): %s - the key might not be set yet", to_save.key.c_str(), esp_err_to_name(err));
       return true;
     }
     stored_data.data.resize(actual_len);
+    s_stats.reads++;
     err = nvs_get_blob(nvs_handle, to_save.key.c_str(), stored_data.data.data(), &actual_len);
     if (err != 0) {
       ESP_LOGV(TAG, "nvs_get_blob('%s') failed: %s", to_save.key.c_str(), esp_err_to_name(err));
@@ -175,6 +283,7 @@ class ESP32Preferences : public ESPPreferences {
   bool reset() override {
     ESP_LOGD(TAG, "Erasing storage");
     s_pending_save.clear();
+    s_shadow.clear();
 
     nvs_flash_deinit();
     nvs_flash_erase();
@@ -184,10 +293,22 @@ class ESP32Preferences : public ESPPreferences {
   }
 };
 
+static ESP32Preferences *s_preferences = nullptr;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+
+// Runs from esp_restart(), after the shutdown sync of a reboot or an OTA
+// update, which leaves the saves deferred by the write interval pending.
+static void write_deferred_on_restart() {
+  ESP_LOGD(TAG, "Writing deferred items before restart");
+  s_preferences->write_pending(true);
+}
+
 void setup_preferences() {
   auto *prefs = new ESP32Preferences();  // NOLINT(cppcoreguidelines-owning-memory)
   prefs->open();
   global_preferences = prefs;
+  s_preferences = prefs;
+  if (USE_ESP32_NVS_MIN_WRITE_INTERVAL > 0)
+    esp_register_shutdown_handler(write_deferred_on_restart);
 }
 
 }  // namespace esp32
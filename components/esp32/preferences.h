@@ -1,10 +1,22 @@
 #pragma once
 #ifdef USE_ESP32
 
+#include <cstdint>
+
 namespace esphome {
 namespace esp32 {
 
+/// Counters of the NVS accesses made by the preferences backend since boot.
+struct NVSStats {
+  uint32_t reads;          ///< nvs_get_blob calls
+  uint32_t writes;         ///< nvs_set_blob calls
+  uint32_t bytes_written;  ///< bytes passed to nvs_set_blob
+  uint32_t skipped;        ///< saves dropped because NVS already holds the data
+  uint32_t deferred;       ///< writes postponed by the minimum write interval
+};
+
 void setup_preferences();
+const NVSStats &get_nvs_stats();
 
 }  // namespace esp32
 }  // namespace esphome
@@ -0,0 +1,81 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome import automation
+from esphome.const import CONF_ID, CONF_TRIGGER_ID
+
+from ..wmbus_radio import RadioComponent, FramePtr
+
+CODEOWNERS = ["@SzczepanLeon", "@kubasaw"]
+
+DEPENDENCIES = ["wmbus_radio", "network"]
+
+CONF_RADIO_ID = "radio_id"
+CONF_STORAGE = "storage"
+CONF_STORAGE_ID = "storage_id"
+CONF_CAPACITY = "capacity"
+CONF_PARTITION = "partition"
+CONF_DRAIN_INTERVAL = "drain_interval"
+CONF_ON_FRAME = "on_frame"
+
+frame_buffer_ns = cg.esphome_ns.namespace("frame_buffer")
+FrameBuffer = frame_buffer_ns.class_("FrameBuffer", cg.Component)
+FrameStorage = frame_buffer_ns.class_("FrameStorage")
+RamFrameStorage = frame_buffer_ns.class_("RamFrameStorage", FrameStorage)
+FlashFrameStorage = frame_buffer_ns.class_("FlashFrameStorage", FrameStorage)
+FrameTrigger = frame_buffer_ns.class_(
+    "FrameTrigger", automation.Trigger.template(FramePtr))
+
+def validate_capacity(config):
+    # The flash storage takes all of its partition.
+    if CONF_CAPACITY in config and config[CONF_STORAGE] == "flash":
+        raise cv.Invalid(
+            f"'{CONF_CAPACITY}' is only supported with {CONF_STORAGE} 'ram'")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(FrameBuffer),
+        cv.GenerateID(CONF_RADIO_ID): cv.use_id(RadioComponent),
+        cv.GenerateID(CONF_STORAGE_ID): cv.declare_id(FrameStorage),
+        # ram uses PSRAM when available, flash uses a data partition with
+        # the given name from a custom partition table.
+        cv.Optional(CONF_STORAGE, default="ram"): cv.one_of(
+            "ram", "flash", lower=True),
+        cv.Optional(CONF_CAPACITY): cv.int_range(
+            min=1024, max=4 * 1024 * 1024),
+        cv.Optional(CONF_PARTITION, default="frames"): cv.string_strict,
+        cv.Optional(
+            CONF_DRAIN_INTERVAL, default="100ms"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_ON_FRAME): automation.validate_automation(
+            {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(FrameTrigger)}
+        ),
+    }
+).extend(cv.COMPONENT_SCHEMA), validate_capacity)
+
+
+async def to_code(config):
+    if config[CONF_STORAGE] == "flash":
+        config[CONF_STORAGE_ID].type = FlashFrameStorage
+        storage = cg.new_Pvariable(
+            config[CONF_STORAGE_ID], config[CONF_PARTITION])
+    else:
+        config[CONF_STORAGE_ID].type = RamFrameStorage
+        storage = cg.new_Pvariable(
+            config[CONF_STORAGE_ID], config.get(CONF_CAPACITY, 16384))
+
+    var = cg.new_Pvariable(config[CONF_ID])
+    cg.add(var.set_storage(storage))
+    cg.add(var.set_drain_interval(config[CONF_DRAIN_INTERVAL]))
+    radio = await cg.get_variable(config[CONF_RADIO_ID])
+    cg.add(var.set_radio(radio))
+    await cg.register_component(var, config)
+
+    for conf in config.get(CONF_ON_FRAME, []):
+        trig = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(
+            trig,
+            [(FramePtr, "frame")],
+            conf,
+        )
@@ -0,0 +1,112 @@
+#include "frame_buffer.h"
+
+#include <cinttypes>
+
+#include "esphome/components/network/util.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace frame_buffer {
+static const char *TAG = "frame_buffer";
+
+void FrameBuffer::set_radio(wmbus_radio::Radio *radio) {
+  radio->add_frame_handler([this](wmbus_radio::Frame *frame) {
+    if (!network::is_connected())
+      this->store_(frame);
+  });
+}
+
+void FrameBuffer::setup() {
+  if (!this->storage_->setup()) {
+    ESP_LOGE(TAG, "Failed to set up %s storage", this->storage_->name());
+    this->mark_failed();
+  }
+}
+
+void FrameBuffer::store_(wmbus_radio::Frame *frame) {
+  if (this->is_failed())
+    return;
+
+  this->record_.clear();
+  frame->append_binary(this->record_);
+  uint32_t overwritten = 0;
+  if (!this->storage_->push(this->record_.data(), this->record_.size(),
+                            &overwritten)) {
+    ESP_LOGW(TAG, "Failed to store frame [%zu bytes]", this->record_.size());
+    return;
+  }
+  this->stored_count_++;
+  if (overwritten != 0) {
+    this->overwritten_count_ += overwritten;
+    ESP_LOGW(TAG, "Buffer full, overwrote %" PRIu32 " oldest frames",
+             overwritten);
+  }
+  ESP_LOGD(TAG, "Stored frame while offline [%zu/%zu bytes used]",
+           this->storage_->used(), this->storage_->capacity());
+}
+
+void FrameBuffer::loop() {
+  if (this->is_failed() || !network::is_connected())
+    return;
+
+  uint32_t now = millis();
+  if (this->draining_ && now - this->last_drain_ < this->drain_interval_)
+    return;
+
+  if (!this->storage_->peek(this->record_)) {
+    if (this->draining_) {
+      uint32_t elapsed = now - this->drain_started_;
+      ESP_LOGI(TAG,
+               "Forwarded %" PRIu32 " stored frames [%" PRIu32
+               " bytes] in %" PRIu32 " ms",
+               this->drain_records_, this->drain_bytes_, elapsed);
+      this->draining_ = false;
+    }
+    return;
+  }
+
+  if (!this->draining_) {
+    this->draining_ = true;
+    this->drain_started_ = now;
+    this->drain_records_ = 0;
+    this->drain_bytes_ = 0;
+  }
+  this->last_drain_ = now;
+
+  auto frame = wmbus_radio::Frame::from_binary(this->record_.data(),
+                                               this->record_.size());
+  if (frame) {
+    for (auto &handler : this->handlers_)
+      handler(&frame.value());
+  } else {
+    ESP_LOGW(TAG, "Skipping invalid stored record [%zu bytes]",
+             this->record_.size());
+  }
+  this->storage_->pop();
+
+  this->drain_records_++;
+  this->drain_bytes_ += this->record_.size();
+  this->drained_count_++;
+  this->drained_bytes_ += this->record_.size();
+}
+
+void FrameBuffer::dump_config() {
+  ESP_LOGCONFIG(TAG, "Frame Buffer:");
+  ESP_LOGCONFIG(TAG, "  Storage: %s", this->storage_->name());
+  if (this->is_failed()) {
+    ESP_LOGE(TAG, "  Storage could not be set up!");
+    return;
+  }
+  ESP_LOGCONFIG(TAG, "  Used: %zu of %zu bytes", this->storage_->used(),
+                this->storage_->capacity());
+  ESP_LOGCONFIG(TAG, "  Drain interval: %" PRIu32 " ms",
+                this->drain_interval_);
+  ESP_LOGCONFIG(TAG,
+                "  Stored: %" PRIu32 ", forwarded: %" PRIu32 " [%" PRIu32
+                " bytes], overwritten: %" PRIu32,
+                this->stored_count_, this->drained_count_,
+                this->drained_bytes_, this->overwritten_count_);
+}
+} // namespace frame_buffer
+} // namespace esphome
@@ -0,0 +1,66 @@
+#pragma once
+#include <functional>
+#include <vector>
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+
+#include "esphome/components/wmbus_radio/component.h"
+
+#include "frame_storage.h"
+
+namespace esphome {
+namespace frame_buffer {
+// Keeps the frames received while the network is down and hands them to
+// the on_frame automations, at a limited rate, once it is back.
+class FrameBuffer : public Component {
+public:
+  void set_radio(wmbus_radio::Radio *radio);
+  void set_storage(FrameStorage *storage) { this->storage_ = storage; }
+  void set_drain_interval(uint32_t drain_interval) {
+    this->drain_interval_ = drain_interval;
+  }
+  void add_on_frame_callback(std::function<void(wmbus_radio::Frame *)> &&cb) {
+    this->handlers_.push_back(std::move(cb));
+  }
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+
+  size_t get_capacity() { return this->storage_->capacity(); }
+  size_t get_used() { return this->storage_->used(); }
+  uint32_t get_stored_count() { return this->stored_count_; }
+  uint32_t get_drained_count() { return this->drained_count_; }
+  uint32_t get_drained_bytes() { return this->drained_bytes_; }
+  uint32_t get_overwritten_count() { return this->overwritten_count_; }
+
+protected:
+  void store_(wmbus_radio::Frame *frame);
+
+  FrameStorage *storage_ = nullptr;
+  uint32_t drain_interval_ = 0;
+  std::vector<std::function<void(wmbus_radio::Frame *)>> handlers_;
+  std::vector<uint8_t> record_;
+
+  uint32_t last_drain_ = 0;
+  bool draining_ = false;
+  uint32_t drain_started_ = 0;
+  uint32_t drain_records_ = 0;
+  uint32_t drain_bytes_ = 0;
+
+  uint32_t stored_count_ = 0;
+  uint32_t drained_count_ = 0;
+  uint32_t drained_bytes_ = 0;
+  uint32_t overwritten_count_ = 0;
+};
+
+class FrameTrigger : public Trigger<wmbus_radio::Frame *> {
+public:
+  explicit FrameTrigger(FrameBuffer *buffer) {
+    buffer->add_on_frame_callback(
+        [this](wmbus_radio::Frame *frame) { this->trigger(frame); });
+  }
+};
+} // namespace frame_buffer
+} // namespace esphome
@@ -0,0 +1,264 @@
+#include "frame_storage.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace frame_buffer {
+static const char *TAG = "frame_buffer.storage";
+
+bool RamFrameStorage::setup() {
+  RAMAllocator<uint8_t> allocator;
+  this->buffer_ = allocator.allocate(this->capacity_);
+  return this->buffer_ != nullptr;
+}
+
+void RamFrameStorage::read_(size_t pos, uint8_t *out, size_t length) {
+  pos %= this->capacity_;
+  size_t first = std::min(length, this->capacity_ - pos);
+  std::memcpy(out, this->buffer_ + pos, first);
+  std::memcpy(out + first, this->buffer_, length - first);
+}
+
+void RamFrameStorage::write_(size_t pos, const uint8_t *data, size_t length) {
+  pos %= this->capacity_;
+  size_t first = std::min(length, this->capacity_ - pos);
+  std::memcpy(this->buffer_ + pos, data, first);
+  std::memcpy(this->buffer_, data + first, length - first);
+}
+
+size_t RamFrameStorage::record_length_(size_t pos) {
+  uint8_t length[2];
+  this->read_(pos, length, 2);
+  return length[0] | length[1] << 8;
+}
+
+bool RamFrameStorage::push(const uint8_t *data, size_t length,
+                           uint32_t *overwritten) {
+  size_t needed = 2 + length;
+  if (length > 0xffff || needed > this->capacity_)
+    return false;
+
+  while (this->capacity_ - this->used_ < needed) {
+    size_t dropped = 2 + this->record_length_(this->head_);
+    this->head_ = (this->head_ + dropped) % this->capacity_;
+    this->used_ -= dropped;
+    this->peeked_ = false;
+    (*overwritten)++;
+  }
+
+  size_t tail = this->head_ + this->used_;
+  uint8_t header[2] = {(uint8_t)(length & 0xff), (uint8_t)(length >> 8)};
+  this->write_(tail, header, 2);
+  this->write_(tail + 2, data, length);
+  this->used_ += needed;
+  return true;
+}
+
+bool RamFrameStorage::peek(std::vector<uint8_t> &out) {
+  if (this->used_ == 0)
+    return false;
+  out.resize(this->record_length_(this->head_));
+  this->read_(this->head_ + 2, out.data(), out.size());
+  this->peeked_ = true;
+  return true;
+}
+
+void RamFrameStorage::pop() {
+  if (!this->peeked_)
+    return;
+  this->peeked_ = false;
+  size_t length = 2 + this->record_length_(this->head_);
+  this->head_ = (this->head_ + length) % this->capacity_;
+  this->used_ -= length;
+}
+
+bool FlashFrameStorage::setup() {
+  this->partition_ =
+      esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY,
+                               this->partition_name_.c_str());
+  if (this->partition_ == nullptr) {
+    ESP_LOGE(TAG, "Partition '%s' not found", this->partition_name_.c_str());
+    return false;
+  }
+  this->sectors_ = this->partition_->size / SECTOR_SIZE;
+  if (this->sectors_ < 2) {
+    ESP_LOGE(TAG, "Partition '%s' needs at least 2 sectors",
+             this->partition_name_.c_str());
+    return false;
+  }
+
+  // The sectors in use hold consecutive sequence numbers, the oldest one is
+  // read from and the newest one is written to.
+  bool found = false;
+  uint32_t oldest = 0;
+  for (size_t sector = 0; sector < this->sectors_; sector++) {
+    uint32_t header[2];
+    if (esp_partition_read(this->partition_, this->offset_(sector, 0), header,
+                           HEADER_SIZE) != ESP_OK ||
+        header[0] != MAGIC)
+      continue;
+    if (!found || header[1] > this->sequence_) {
+      this->sequence_ = header[1];
+      this->write_sector_ = sector;
+    }
+    if (!found || header[1] < oldest) {
+      oldest = header[1];
+      this->read_sector_ = sector;
+    }
+    found = true;
+  }
+
+  if (!found)
+    return this->start_sector_(0);
+
+  uint32_t records = 0;
+  this->write_pos_ =
+      this->end_of_records_(this->write_sector_, HEADER_SIZE, &records);
+  // Skip the records that were read before the reboot.
+  this->read_pos_ = HEADER_SIZE;
+  for (;;) {
+    bool unread;
+    uint16_t length =
+        this->record_length_(this->read_sector_, this->read_pos_, &unread);
+    if (length == 0xffff || unread)
+      break;
+    this->read_pos_ += 2 + length;
+  }
+  ESP_LOGI(TAG, "Resuming with %zu bytes of stored frames", this->used());
+  return true;
+}
+
+uint16_t FlashFrameStorage::record_length_(size_t sector, size_t pos,
+                                           bool *unread) {
+  uint16_t length = 0xffff;
+  if (pos + 2 <= SECTOR_SIZE)
+    esp_partition_read(this->partition_, this->offset_(sector, pos), &length,
+                       2);
+  if (length == 0xffff)
+    return length;
+  if (unread != nullptr)
+    *unread = (length & UNREAD) != 0;
+  length &= ~UNREAD;
+  if (pos + 2 + length > SECTOR_SIZE)
+    length = 0xffff;
+  return length;
+}
+
+size_t FlashFrameStorage::end_of_records_(size_t sector, size_t pos,
+                                          uint32_t *count) {
+  for (;;) {
+    uint16_t length = this->record_length_(sector, pos);
+    if (length == 0xffff)
+      return pos;
+    pos += 2 + length;
+    (*count)++;
+  }
+}
+
+bool FlashFrameStorage::start_sector_(size_t sector) {
+  uint32_t header[2];
+  esp_partition_read(this->partition_, this->offset_(sector, 0), header,
+                     HEADER_SIZE);
+  // Sectors are erased once they have been read, only erase here if not.
+  if ((header[0] != 0xffffffff || header[1] != 0xffffffff) &&
+      esp_partition_erase_range(this->partition_, this->offset_(sector, 0),
+                                SECTOR_SIZE) != ESP_OK)
+    return false;
+
+  header[0] = MAGIC;
+  header[1] = ++this->sequence_;
+  if (esp_partition_write(this->partition_, this->offset_(sector, 0), header,
+                          HEADER_SIZE) != ESP_OK)
+    return false;
+  this->write_sector_ = sector;
+  this->write_pos_ = HEADER_SIZE;
+  return true;
+}
+
+void FlashFrameStorage::leave_read_sector_() {
+  esp_partition_erase_range(this->partition_,
+                            this->offset_(this->read_sector_, 0), SECTOR_SIZE);
+  this->read_sector_ = (this->read_sector_ + 1) % this->sectors_;
+  this->read_pos_ = HEADER_SIZE;
+}
+
+bool FlashFrameStorage::push(const uint8_t *data, size_t length,
+                             uint32_t *overwritten) {
+  if (HEADER_SIZE + 2 + length > SECTOR_SIZE)
+    return false;
+
+  if (this->write_pos_ + 2 + length > SECTOR_SIZE) {
+    size_t next = (this->write_sector_ + 1) % this->sectors_;
+    if (next == this->read_sector_) {
+      // Full, drop the unread records of the oldest sector.
+      this->end_of_records_(this->read_sector_, this->read_pos_, overwritten);
+      this->read_sector_ = (next + 1) % this->sectors_;
+      this->read_pos_ = HEADER_SIZE;
+      this->peeked_ = false;
+    }
+    if (!this->start_sector_(next))
+      return false;
+  }
+
+  uint16_t record_length = length | UNREAD;
+  size_t offset = this->offset_(this->write_sector_, this->write_pos_);
+  // The length is written first, a record cut short by a reset is then
+  // still skipped correctly.
+  if (esp_partition_write(this->partition_, offset, &record_length, 2) !=
+          ESP_OK ||
+      esp_partition_write(this->partition_, offset + 2, data, length) != ESP_OK)
+    return false;
+  this->write_pos_ += 2 + length;
+  return true;
+}
+
+bool FlashFrameStorage::peek(std::vector<uint8_t> &out) {
+  for (;;) {
+    if (this->read_sector_ == this->write_sector_ &&
+        this->read_pos_ >= this->write_pos_)
+      return false;
+    uint16_t length = this->record_length_(this->read_sector_, this->read_pos_);
+    if (length == 0xffff) {
+      if (this->read_sector_ == this->write_sector_)
+        return false;
+      this->leave_read_sector_();
+      continue;
+    }
+    out.resize(length);
+    esp_partition_read(this->partition_,
+                       this->offset_(this->read_sector_, this->read_pos_ + 2),
+                       out.data(), length);
+    this->peeked_length_ = length;
+    this->peeked_ = true;
+    return true;
+  }
+}
+
+void FlashFrameStorage::pop() {
+  if (!this->peeked_)
+    return;
+  // Clear the unread bit, so the record is not read again after a reboot.
+  uint16_t record_length = this->peeked_length_;
+  esp_partition_write(this->partition_,
+                      this->offset_(this->read_sector_, this->read_pos_),
+                      &record_length, 2);
+  this->read_pos_ += 2 + this->peeked_length_;
+  this->peeked_ = false;
+}
+
+size_t FlashFrameStorage::capacity() {
+  return this->sectors_ * (SECTOR_SIZE - HEADER_SIZE);
+}
+
+size_t FlashFrameStorage::used() {
+  size_t sectors =
+      (this->write_sector_ + this->sectors_ - this->read_sector_) %
+      this->sectors_;
+  return sectors * SECTOR_SIZE + this->write_pos_ - this->read_pos_;
+}
+} // namespace frame_buffer
+} // namespace esphome
@@ -0,0 +1,100 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "esp_partition.h"
+
+namespace esphome {
+namespace frame_buffer {
+// A bounded queue of records. When full, the oldest records are overwritten.
+class FrameStorage {
+public:
+  virtual ~FrameStorage() = default;
+  virtual bool setup() = 0;
+  // Append a record, *overwritten is increased by the number of old records
+  // that were dropped to make room for it.
+  virtual bool push(const uint8_t *data, size_t length,
+                    uint32_t *overwritten) = 0;
+  // Copy the oldest record into out, false if there is none.
+  virtual bool peek(std::vector<uint8_t> &out) = 0;
+  // Remove the record returned by the last peek.
+  virtual void pop() = 0;
+  virtual size_t capacity() = 0;
+  virtual size_t used() = 0;
+  virtual const char *name() = 0;
+};
+
+// Ring buffer in PSRAM if available, otherwise in internal RAM.
+// Each record is stored as a 2 byte length followed by the data.
+class RamFrameStorage : public FrameStorage {
+public:
+  RamFrameStorage(size_t capacity) : capacity_(capacity) {}
+  bool setup() override;
+  bool push(const uint8_t *data, size_t length, uint32_t *overwritten) override;
+  bool peek(std::vector<uint8_t> &out) override;
+  void pop() override;
+  size_t capacity() override { return this->capacity_; }
+  size_t used() override { return this->used_; }
+  const char *name() override { return "RAM"; }
+
+protected:
+  void read_(size_t pos, uint8_t *out, size_t length);
+  void write_(size_t pos, const uint8_t *data, size_t length);
+  size_t record_length_(size_t pos);
+
+  uint8_t *buffer_ = nullptr;
+  size_t capacity_;
+  size_t head_ = 0;
+  size_t used_ = 0;
+  bool peeked_ = false;
+};
+
+// Append only log in a data partition, used as a ring of flash sectors.
+// Each sector starts with a header holding a sequence number, followed by
+// records stored as a 2 byte length and the data. Unwritten flash reads as
+// 0xffff, which marks the end of the records in a sector. Sectors are
+// erased once all their records have been read, or when the writer wraps
+// around onto unread records, so every sector is erased once per lap.
+// The top bit of the length is set while a record is unread. It is cleared
+// when the record is popped, which flash allows without an erase, so that
+// records already read are skipped after a reboot.
+class FlashFrameStorage : public FrameStorage {
+public:
+  FlashFrameStorage(std::string partition) : partition_name_(partition) {}
+  bool setup() override;
+  bool push(const uint8_t *data, size_t length, uint32_t *overwritten) override;
+  bool peek(std::vector<uint8_t> &out) override;
+  void pop() override;
+  size_t capacity() override;
+  size_t used() override;
+  const char *name() override { return "flash"; }
+
+protected:
+  size_t offset_(size_t sector, size_t pos) {
+    return sector * SECTOR_SIZE + pos;
+  }
+  uint16_t record_length_(size_t sector, size_t pos, bool *unread = nullptr);
+  size_t end_of_records_(size_t sector, size_t pos, uint32_t *count);
+  bool start_sector_(size_t sector);
+  void leave_read_sector_();
+
+  static const size_t SECTOR_SIZE = 4096;
+  static const size_t HEADER_SIZE = 8;
+  static const uint32_t MAGIC = 0x42464d57; // "WMFB"
+  static const uint16_t UNREAD = 0x8000;
+
+  std::string partition_name_;
+  const esp_partition_t *partition_ = nullptr;
+  size_t sectors_ = 0;
+  uint32_t sequence_ = 0;
+  size_t write_sector_ = 0;
+  size_t write_pos_ = HEADER_SIZE;
+  size_t read_sector_ = 0;
+  size_t read_pos_ = HEADER_SIZE;
+  size_t peeked_length_ = 0;
+  bool peeked_ = false;
+};
+} // namespace frame_buffer
+} // namespace esphome
@@ -9,6 +9,14 @@ MULTI_CONF = True
 
 CODEOWNERS = ["@SzczepanLeon", "@kubasaw"]
 
+CONF_PERSISTENT = "persistent"
+CONF_QUEUE_SIZE = "queue_size"
+CONF_BATCH = "batch"
+CONF_MTU = "mtu"
+CONF_MAX_LATENCY = "max_latency"
+CONF_DESTINATIONS = "destinations"
+CONF_DNS_TTL = "dns_ttl"
+
 
 socket_ns = cg.esphome_ns.namespace("socket_transmitter")
 SocketTransmitter = socket_ns.class_("SocketTransmitter", cg.Component)
@@ -16,11 +24,31 @@ SocketTransmitterSendAction = socket_ns.class_(
     "SocketTransmitterSendAction", automation.Action
 )
 
-CONFIG_SCHEMA = cv.Schema(
+
+HOST_SCHEMA = cv.All(cv.Any(cv.ipv4address, cv.domain_name), cv.string)
+
+DESTINATION_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_IP_ADDRESS): HOST_SCHEMA,
+        cv.Required(CONF_PORT): cv.port,
+    }
+)
+
+
+def validate_batch(config):
+    if CONF_BATCH in config and config[CONF_PROTOCOL] != "UDP":
+        raise cv.Invalid(f"'{CONF_BATCH}' is only supported with protocol UDP")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(SocketTransmitter),
-        cv.Required(CONF_IP_ADDRESS): cv.All(cv.ipv4address, cv.string),
+        cv.Required(CONF_IP_ADDRESS): HOST_SCHEMA,
         cv.Required(CONF_PORT): cv.port,
+        cv.Optional(CONF_DESTINATIONS, default=[]): cv.ensure_list(
+            DESTINATION_SCHEMA
+        ),
         cv.Required(CONF_PROTOCOL): cv.enum(
             {
                 "TCP": cg.RawExpression("SOCK_STREAM"),
@@ -28,15 +56,42 @@ CONFIG_SCHEMA = cv.Schema(
             },
             upper=True,
         ),
+        cv.Optional(CONF_PERSISTENT, default=False): cv.boolean,
+        cv.Optional(CONF_QUEUE_SIZE, default=4096): cv.int_range(
+            min=256, max=65536
+        ),
+        cv.Optional(
+            CONF_DNS_TTL, default="5min"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_BATCH): cv.Schema(
+            {
+                cv.Optional(CONF_MTU, default=1400): cv.int_range(
+                    min=64, max=65507
+                ),
+                cv.Optional(
+                    CONF_MAX_LATENCY, default="100ms"
+                ): cv.positive_time_period_milliseconds,
+            }
+        ),
     }
-)
+), validate_batch)
 
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
-    cg.add(var.set_host(config[CONF_IP_ADDRESS]))
-    cg.add(var.set_port(config[CONF_PORT]))
+    cg.add(var.add_destination(config[CONF_IP_ADDRESS], config[CONF_PORT]))
+    for destination in config[CONF_DESTINATIONS]:
+        cg.add(
+            var.add_destination(destination[CONF_IP_ADDRESS], destination[CONF_PORT])
+        )
     cg.add(var.set_protocol(config[CONF_PROTOCOL]))
+    cg.add(var.set_persistent(config[CONF_PERSISTENT]))
+    cg.add(var.set_dns_ttl(config[CONF_DNS_TTL]))
+    if config[CONF_PERSISTENT]:
+        cg.add(var.set_queue_size(config[CONF_QUEUE_SIZE]))
+    if CONF_BATCH in config:
+        batch = config[CONF_BATCH]
+        cg.add(var.set_batch(batch[CONF_MTU], batch[CONF_MAX_LATENCY]))
 
     await cg.register_component(var, config)
 
@@ -1,44 +1,435 @@
 #include "socket_transmitter.h"
+#include "esphome/core/hal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstring>
+#include <netdb.h>
+#include <string>
 
 namespace esphome {
 namespace socket_transmitter {
-void SocketTransmitter::send(std::string data) {
-  return this->send((uint8_t *)data.c_str(), data.length());
+static const uint32_t CONNECT_TIMEOUT_MS = 5000;
+static const uint32_t MIN_BACKOFF_MS = 1000;
+static const uint32_t MAX_BACKOFF_MS = 60000;
+
+void Destination::setup() {
+  if (this->parent_->is_persistent() &&
+      this->parent_->get_protocol() == SOCK_STREAM)
+    this->queue_.resize(this->parent_->get_queue_size());
 }
 
-void SocketTransmitter::send(std::vector<uint8_t> data) {
-  return this->send(data.data(), data.size());
+bool Destination::resolve_() {
+  struct addrinfo hints {};
+#if USE_NETWORK_IPV6
+  hints.ai_family = AF_UNSPEC;
+#else
+  hints.ai_family = AF_INET;
+#endif
+  hints.ai_socktype = this->parent_->get_protocol();
+  struct addrinfo *result = nullptr;
+  std::string port = std::to_string(this->port_);
+  int err = getaddrinfo(this->host_.c_str(), port.c_str(), &hints, &result);
+  this->resolved_at_ = millis();
+  this->stale_ = false;
+  if (err != 0 || result == nullptr ||
+      result->ai_addrlen > sizeof(this->address_)) {
+    if (result != nullptr)
+      freeaddrinfo(result);
+    // Keep sending to the previous address until a lookup succeeds, it is
+    // retried after the dns ttl or the next failure.
+    ESP_LOGW(TAG, "Failed to resolve %s, error %d%s", this->host_.c_str(), err,
+             this->resolved_ ? ", keeping the previous address" : "");
+    return this->resolved_;
+  }
+  sockaddr_storage address{};
+  socklen_t address_length = result->ai_addrlen;
+  std::memcpy(&address, result->ai_addr, address_length);
+  freeaddrinfo(result);
+  // A persistent socket to the old address is reconnected to the new one.
+  if ((address_length != this->address_length_ ||
+       std::memcmp(&address, &this->address_, address_length) != 0) &&
+      this->socket_ != nullptr && this->queue_used_ == 0)
+    this->disconnect_();
+  this->address_ = address;
+  this->address_length_ = address_length;
+  this->resolved_ = true;
+  return true;
 }
 
-void SocketTransmitter::send(const uint8_t *data, size_t length) {
+bool Destination::resolve_due_() const {
+  if (this->stale_)
+    return true;
+  uint32_t interval =
+      this->resolved_ ? this->parent_->get_dns_ttl() : MIN_BACKOFF_MS;
+  return millis() - this->resolved_at_ >= interval;
+}
+
+void Destination::send(const uint8_t *data, size_t length) {
+  uint32_t started = micros();
+  if (this->resolve_due_())
+    this->resolve_();
+
+  if (!this->resolved_) {
+    this->failures_++;
+    this->dropped_bytes_ += length;
+  } else if (!this->parent_->is_persistent()) {
+    this->send_once_(data, length);
+  } else {
+    this->send_persistent_(data, length);
+  }
+
+  uint32_t latency = micros() - started;
+  this->sends_++;
+  this->latency_sum_us_ += latency;
+  this->max_latency_us_ = std::max(this->max_latency_us_, latency);
+}
+
+void Destination::send_once_(const uint8_t *data, size_t length) {
   ESP_LOGD(TAG, "Setting up socket transmitter");
-  this->socket_ = socket::socket_ip(this->protocol, 0);
+  this->socket_ = socket::socket(this->address_.ss_family,
+                                 this->parent_->get_protocol(), 0);
+  if (this->socket_ == nullptr) {
+    ESP_LOGE(TAG, "Failed to create socket");
+    this->failures_++;
+    this->dropped_bytes_ += length;
+    return;
+  }
   int enable = 1;
   this->socket_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
 
-  ESP_LOGD(TAG, "Connecting %s ...",
-           this->protocol == SOCK_DGRAM ? "UDP" : "TCP");
-  sockaddr destination;
-  socket::set_sockaddr(&destination, sizeof(destination), this->host,
-                       this->port);
-  if (this->socket_->connect(&destination, sizeof(destination)) < 0) {
+  ESP_LOGD(TAG, "Connecting %s to %s:%d ...",
+           this->parent_->get_protocol() == SOCK_DGRAM ? "UDP" : "TCP",
+           this->host_.c_str(), this->port_);
+  if (this->socket_->connect((sockaddr *)&this->address_,
+                             this->address_length_) < 0) {
     ESP_LOGE(TAG, "Failed to connect");
+    this->dropped_bytes_ += length;
+    this->fail_();
     return;
   }
 
-  ESP_LOGD(TAG, "Sending frame [%d bytes]", length);
+  ESP_LOGD(TAG, "Sending frame [%zu bytes]", length);
   int n_bytes = this->socket_->write(data, length);
-  if (n_bytes < 0)
+  if (n_bytes < 0) {
     ESP_LOGE(TAG, "Failed to send message");
-  this->socket_->close();
+    this->dropped_bytes_ += length;
+    this->fail_();
+    return;
+  }
+  this->sent_bytes_ += length;
+  this->disconnect_();
+}
+
+void Destination::send_persistent_(const uint8_t *data, size_t length) {
+  if (this->parent_->get_protocol() == SOCK_DGRAM) {
+    // Datagrams are sent as they are, there is no stream to keep in order.
+    if (this->socket_ == nullptr && !this->connect_()) {
+      this->dropped_bytes_ += length;
+      return;
+    }
+    if (this->socket_->write(data, length) < 0) {
+      ESP_LOGW(TAG, "Failed to send datagram to %s, errno %d",
+               this->host_.c_str(), errno);
+      this->dropped_bytes_ += length;
+      this->fail_();
+      return;
+    }
+    this->sent_bytes_ += length;
+    return;
+  }
+
+  this->enqueue_(data, length);
+  this->drain_();
+}
+
+bool Destination::connect_() {
+  if (this->parent_->get_protocol() == SOCK_STREAM)
+    this->drop_partial_frame_();
+  ESP_LOGD(TAG, "Connecting %s to %s:%d ...",
+           this->parent_->get_protocol() == SOCK_DGRAM ? "UDP" : "TCP",
+           this->host_.c_str(), this->port_);
+  this->socket_ = socket::socket(this->address_.ss_family,
+                                 this->parent_->get_protocol(), 0);
+  if (this->socket_ == nullptr) {
+    ESP_LOGW(TAG, "Failed to create socket");
+    this->failures_++;
+    return false;
+  }
+  int enable = 1;
+  this->socket_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  if (this->parent_->get_protocol() == SOCK_STREAM) {
+    this->socket_->setsockopt(IPPROTO_TCP, TCP_NODELAY, &enable,
+                              sizeof(enable));
+    this->socket_->setblocking(false);
+  }
+
+  if (this->socket_->connect((sockaddr *)&this->address_,
+                             this->address_length_) < 0 &&
+      errno != EINPROGRESS) {
+    ESP_LOGW(TAG, "Failed to connect, errno %d", errno);
+    this->fail_();
+    return false;
+  }
+  this->connected_ = this->parent_->get_protocol() == SOCK_DGRAM;
+  this->connect_started_ = millis();
+  return true;
+}
+
+void Destination::disconnect_() {
+  if (this->socket_ != nullptr)
+    this->socket_->close();
+  this->socket_ = nullptr;
+  this->connected_ = false;
+}
+
+void Destination::fail_() {
+  // The address might have changed, resolve it again on the next attempt.
+  this->failures_++;
+  this->stale_ = true;
+  this->disconnect_();
+}
+
+void Destination::schedule_reconnect_() {
+  this->backoff_ = this->backoff_ == 0
+                       ? MIN_BACKOFF_MS
+                       : std::min(this->backoff_ * 2, MAX_BACKOFF_MS);
+  this->next_connect_ = millis() + this->backoff_;
+  ESP_LOGW(TAG, "Reconnecting to %s in %" PRIu32 " ms", this->host_.c_str(),
+           this->backoff_);
+}
+
+void Destination::enqueue_(const uint8_t *data, size_t length) {
+  size_t size = this->queue_.size();
+  if (length == 0)
+    return;
+  // A partly queued frame would corrupt the stream, drop it as a whole.
+  if (length > size - this->queue_used_) {
+    ESP_LOGW(TAG, "Queue for %s full, dropping frame [%zu bytes]",
+             this->host_.c_str(), length);
+    this->dropped_bytes_ += length;
+    return;
+  }
+  size_t tail = (this->queue_head_ + this->queue_used_) % size;
+  size_t first = std::min(length, size - tail);
+  std::copy(data, data + first, this->queue_.begin() + tail);
+  std::copy(data + first, data + length, this->queue_.begin());
+  this->queue_used_ += length;
+  this->queued_bytes_ += length;
+  this->frame_lengths_.push_back(length);
+}
+
+void Destination::drop_partial_frame_() {
+  // The rest of a frame cut off by the lost connection would start the new
+  // stream in the middle of a record.
+  if (this->head_frame_sent_ == 0)
+    return;
+  size_t rest = this->frame_lengths_.front() - this->head_frame_sent_;
+  ESP_LOGW(TAG, "Dropping the rest of a partly sent frame to %s [%zu bytes]",
+           this->host_.c_str(), rest);
+  this->queue_head_ = (this->queue_head_ + rest) % this->queue_.size();
+  this->queue_used_ -= rest;
+  this->dropped_bytes_ += rest;
+  this->frame_lengths_.pop_front();
+  this->head_frame_sent_ = 0;
+}
+
+void Destination::drain_() {
+  if (this->queue_used_ == 0)
+    return;
+
+  if (this->socket_ == nullptr) {
+    if ((int32_t)(millis() - this->next_connect_) < 0)
+      return;
+    if (this->resolve_due_())
+      this->resolve_();
+    if (!this->resolved_ || !this->connect_()) {
+      this->schedule_reconnect_();
+      return;
+    }
+  }
+
+  while (this->queue_used_ > 0) {
+    size_t chunk =
+        std::min(this->queue_used_, this->queue_.size() - this->queue_head_);
+    ssize_t n = this->socket_->write(&this->queue_[this->queue_head_], chunk);
+    // Nothing written is handled like a full send buffer, retry from loop().
+    if (n <= 0) {
+      if (n == 0 || errno == EAGAIN || errno == EWOULDBLOCK ||
+          errno == EINPROGRESS || errno == EALREADY) {
+        // Still connecting or the send buffer is full, retry from loop().
+        if (!this->connected_ &&
+            millis() - this->connect_started_ > CONNECT_TIMEOUT_MS) {
+          ESP_LOGW(TAG, "Timeout connecting to %s:%d", this->host_.c_str(),
+                   this->port_);
+          this->fail_();
+          this->schedule_reconnect_();
+        }
+        return;
+      }
+      ESP_LOGW(TAG, "Failed to send to %s, errno %d", this->host_.c_str(),
+               errno);
+      this->fail_();
+      this->schedule_reconnect_();
+      return;
+    }
+    if (!this->connected_) {
+      ESP_LOGD(TAG, "Connected to %s:%d", this->host_.c_str(), this->port_);
+      this->connected_ = true;
+      this->backoff_ = 0;
+    }
+    this->queue_head_ = (this->queue_head_ + n) % this->queue_.size();
+    this->queue_used_ -= n;
+    this->sent_bytes_ += n;
+    this->head_frame_sent_ += n;
+    while (!this->frame_lengths_.empty() &&
+           this->head_frame_sent_ >= this->frame_lengths_.front()) {
+      this->head_frame_sent_ -= this->frame_lengths_.front();
+      this->frame_lengths_.pop_front();
+    }
+  }
+}
+
+void Destination::loop() {
+  if (this->parent_->is_persistent())
+    this->drain_();
+}
+
+void Destination::dump_config() {
+  ESP_LOGCONFIG(TAG, "  Destination: %s:%d", this->host_.c_str(), this->port_);
+  if (this->parent_->is_persistent() &&
+      this->parent_->get_protocol() == SOCK_STREAM)
+    ESP_LOGCONFIG(TAG, "    Queue size: %zu bytes", this->queue_.size());
+  ESP_LOGCONFIG(TAG,
+                "    Queued: %" PRIu32 " bytes, sent: %" PRIu32
+                " bytes, dropped: %" PRIu32 " bytes, failures: %" PRIu32,
+                this->queued_bytes_, this->sent_bytes_, this->dropped_bytes_,
+                this->failures_);
+  if (this->sends_ > 0)
+    ESP_LOGCONFIG(TAG,
+                  "    Send latency: avg %" PRIu32 " us, max %" PRIu32 " us",
+                  (uint32_t)(this->latency_sum_us_ / this->sends_),
+                  this->max_latency_us_);
+}
+
+void SocketTransmitter::send(std::string data) {
+  return this->send((uint8_t *)data.c_str(), data.length());
+}
+
+void SocketTransmitter::send(std::vector<uint8_t> data) {
+  return this->send(data.data(), data.size());
+}
+
+void SocketTransmitter::send(const uint8_t *data, size_t length) {
+  if (this->batch_mtu_ > 0)
+    return this->add_to_batch_(data, length);
+  this->send_now_(data, length);
+}
+
+void SocketTransmitter::send_now_(const uint8_t *data, size_t length) {
+  for (auto &destination : this->destinations_)
+    destination->send(data, length);
+}
+
+void SocketTransmitter::add_to_batch_(const uint8_t *data, size_t length) {
+  if (length > 0xffff) {
+    ESP_LOGW(TAG, "Frame too long for batching [%zu bytes]", length);
+    this->dropped_bytes_ += length;
+    return;
+  }
+  if (this->batch_records_ > 0 &&
+      this->batch_.size() + 2 + length > this->batch_mtu_)
+    this->flush_batch_();
+
+  if (this->batch_records_ == 0)
+    this->batch_started_ = millis();
+  this->batch_.push_back(length >> 8);
+  this->batch_.push_back(length & 0xff);
+  this->batch_.insert(this->batch_.end(), data, data + length);
+  this->batch_records_++;
+
+  // A record larger than the mtu is sent in a datagram of its own.
+  if (this->batch_.size() >= this->batch_mtu_)
+    this->flush_batch_();
+}
+
+void SocketTransmitter::flush_batch_() {
+  if (this->batch_records_ == 0)
+    return;
+
+  uint32_t latency = millis() - this->batch_started_;
+  this->send_now_(this->batch_.data(), this->batch_.size());
+  this->batches_sent_++;
+  this->batched_records_ += this->batch_records_;
+  this->batched_bytes_ += this->batch_.size();
+  this->flush_latency_sum_ += latency;
+  this->max_flush_latency_ = std::max(this->max_flush_latency_, latency);
+  ESP_LOGV(TAG, "Sent batch of %zu records [%zu bytes] after %" PRIu32 " ms",
+           this->batch_records_, this->batch_.size(), latency);
+
+  this->batch_.clear();
+  this->batch_records_ = 0;
+}
+
+void SocketTransmitter::setup() {
+  for (auto &destination : this->destinations_)
+    destination->setup();
+}
+
+void SocketTransmitter::loop() {
+  if (this->batch_records_ > 0 &&
+      millis() - this->batch_started_ >= this->batch_max_latency_)
+    this->flush_batch_();
+  for (auto &destination : this->destinations_)
+    destination->loop();
+}
+
+uint32_t SocketTransmitter::get_queued_bytes() const {
+  uint32_t total = 0;
+  for (auto &destination : this->destinations_)
+    total += destination->get_queued_bytes();
+  return total;
+}
+
+uint32_t SocketTransmitter::get_sent_bytes() const {
+  uint32_t total = 0;
+  for (auto &destination : this->destinations_)
+    total += destination->get_sent_bytes();
+  return total;
+}
+
+uint32_t SocketTransmitter::get_dropped_bytes() const {
+  uint32_t total = this->dropped_bytes_;
+  for (auto &destination : this->destinations_)
+    total += destination->get_dropped_bytes();
+  return total;
 }
 
 void SocketTransmitter::dump_config() {
   auto protocol = this->protocol == SOCK_DGRAM ? "UDP" : "TCP";
 
   ESP_LOGCONFIG(TAG, "Socket Transmitter:");
-  ESP_LOGCONFIG(TAG, "  Destination: %s:%d", this->host.c_str(), this->port);
   ESP_LOGCONFIG(TAG, "  Protocol: %s", protocol);
+  ESP_LOGCONFIG(TAG, "  Persistent: %s", YESNO(this->persistent_));
+  ESP_LOGCONFIG(TAG, "  DNS TTL: %" PRIu32 " ms", this->dns_ttl_);
+  if (this->batch_mtu_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Batch MTU: %zu bytes", this->batch_mtu_);
+    ESP_LOGCONFIG(TAG, "  Batch max latency: %" PRIu32 " ms",
+                  this->batch_max_latency_);
+    if (this->batches_sent_ > 0)
+      ESP_LOGCONFIG(TAG,
+                    "  Batches: %" PRIu32 ", avg %" PRIu32
+                    " records [%" PRIu32 " bytes], avg latency %" PRIu32
+                    " ms, max %" PRIu32 " ms",
+                    this->batches_sent_,
+                    this->batched_records_ / this->batches_sent_,
+                    this->batched_bytes_ / this->batches_sent_,
+                    this->flush_latency_sum_ / this->batches_sent_,
+                    this->max_flush_latency_);
+  }
+  for (auto &destination : this->destinations_)
+    destination->dump_config();
 }
 } // namespace socket_transmitter
 } // namespace esphome
@@ -1,4 +1,6 @@
 #pragma once
+#include <deque>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -11,24 +13,144 @@ namespace esphome {
 namespace socket_transmitter {
 static const char *TAG = "socket_transmitter";
 
+class SocketTransmitter;
+
+// A collector the data is sent to. Keeps the resolved address and, in
+// persistent mode, the socket and the queue of unsent TCP data.
+class Destination {
+public:
+  Destination(SocketTransmitter *parent, std::string host, int port)
+      : parent_(parent), host_(host), port_(port) {}
+  void setup();
+  void send(const uint8_t *data, size_t length);
+  void loop();
+  void dump_config();
+
+  const std::string &get_host() const { return this->host_; }
+  int get_port() const { return this->port_; }
+  uint32_t get_queued_bytes() const { return this->queued_bytes_; }
+  uint32_t get_sent_bytes() const { return this->sent_bytes_; }
+  uint32_t get_dropped_bytes() const { return this->dropped_bytes_; }
+  uint32_t get_failures() const { return this->failures_; }
+  uint32_t get_max_send_latency() const { return this->max_latency_us_; }
+
+protected:
+  bool resolve_();
+  bool resolve_due_() const;
+  void send_once_(const uint8_t *data, size_t length);
+  void send_persistent_(const uint8_t *data, size_t length);
+  bool connect_();
+  void disconnect_();
+  void fail_();
+  void schedule_reconnect_();
+  void enqueue_(const uint8_t *data, size_t length);
+  void drop_partial_frame_();
+  void drain_();
+
+  SocketTransmitter *parent_;
+  std::string host_;
+  int port_;
+
+  // The address is resolved once and again after the dns ttl has passed or
+  // when connecting or sending fails. A failed lookup keeps the previous
+  // address, without one it is retried at most once a second.
+  sockaddr_storage address_{};
+  socklen_t address_length_ = 0;
+  bool resolved_ = false;
+  bool stale_ = true;
+  uint32_t resolved_at_ = 0;
+
+  // In persistent mode the socket is kept open between sends. TCP data is
+  // queued in a ring buffer and written without blocking from loop().
+  std::unique_ptr<socket::Socket> socket_;
+  std::vector<uint8_t> queue_;
+  size_t queue_head_ = 0;
+  size_t queue_used_ = 0;
+  // Lengths of the queued frames, and how much of the first one has been
+  // sent, so that a frame cut off by a lost connection is not resumed.
+  std::deque<size_t> frame_lengths_;
+  size_t head_frame_sent_ = 0;
+  bool connected_ = false;
+  uint32_t connect_started_ = 0;
+  uint32_t next_connect_ = 0;
+  uint32_t backoff_ = 0;
+
+  uint32_t queued_bytes_ = 0;
+  uint32_t sent_bytes_ = 0;
+  uint32_t dropped_bytes_ = 0;
+  uint32_t failures_ = 0;
+  uint32_t sends_ = 0;
+  uint64_t latency_sum_us_ = 0;
+  uint32_t max_latency_us_ = 0;
+};
+
 class SocketTransmitter : public Component {
 public:
-  void set_host(std::string host) { this->host = host; };
-  void set_port(int port) { this->port = port; };
+  void add_destination(std::string host, int port) {
+    this->destinations_.emplace_back(new Destination(this, host, port));
+  };
   void set_protocol(int protocol) { this->protocol = protocol; };
+  void set_persistent(bool persistent) { this->persistent_ = persistent; };
+  void set_queue_size(size_t queue_size) { this->queue_size_ = queue_size; };
+  void set_dns_ttl(uint32_t dns_ttl) { this->dns_ttl_ = dns_ttl; };
+  void set_batch(size_t mtu, uint32_t max_latency) {
+    this->batch_mtu_ = mtu;
+    this->batch_max_latency_ = max_latency;
+    this->batch_.reserve(mtu);
+  };
+  int get_protocol() const { return this->protocol; }
+  bool is_persistent() const { return this->persistent_; }
+  size_t get_queue_size() const { return this->queue_size_; }
+  uint32_t get_dns_ttl() const { return this->dns_ttl_; }
+
   void send(std::string data);
   void send(std::vector<uint8_t> data);
   void send(const uint8_t *data, size_t length);
+  void setup() override;
+  void loop() override;
   void dump_config() override;
   float get_setup_priority() const override {
     return setup_priority::AFTER_CONNECTION;
   }
 
+  Destination *get_destination(size_t index) {
+    return this->destinations_[index].get();
+  }
+  uint32_t get_queued_bytes() const;
+  uint32_t get_sent_bytes() const;
+  uint32_t get_dropped_bytes() const;
+  uint32_t get_batches_sent() const { return this->batches_sent_; }
+  uint32_t get_batched_records() const { return this->batched_records_; }
+  uint32_t get_max_flush_latency() const { return this->max_flush_latency_; }
+
 protected:
-  std::string host;
-  int port;
+  void send_now_(const uint8_t *data, size_t length);
+  void add_to_batch_(const uint8_t *data, size_t length);
+  void flush_batch_();
+
   int protocol;
-  std::unique_ptr<socket::Socket> socket_;
+  bool persistent_ = false;
+  size_t queue_size_ = 0;
+  uint32_t dns_ttl_ = 0;
+  // The data is serialised once and written to every destination.
+  std::vector<std::unique_ptr<Destination>> destinations_;
+  // Frames dropped before reaching any destination.
+  uint32_t dropped_bytes_ = 0;
+
+  // With batching, UDP records are packed into datagrams of up to
+  // batch_mtu_ bytes. Each record is prefixed with its length as two bytes,
+  // big endian. A batch is flushed when full or batch_max_latency_ ms after
+  // its first record.
+  size_t batch_mtu_ = 0;
+  uint32_t batch_max_latency_ = 0;
+  std::vector<uint8_t> batch_;
+  size_t batch_records_ = 0;
+  uint32_t batch_started_ = 0;
+  uint32_t batches_sent_ = 0;
+  uint32_t batched_records_ = 0;
+  uint32_t batched_bytes_ = 0;
+  uint32_t flush_latency_sum_ = 0;
+  uint32_t max_flush_latency_ = 0;
 };
 
 template <typename StrOrVector, typename... Ts>
@@ -6,6 +6,7 @@ from pathlib import Path
 
 CODEOWNERS = ["@SzczepanLeon", "@kubasaw"]
 CONF_DRIVERS = "drivers"
+CONF_MANUFACTURER_NAMES = "manufacturer_names"
 
 wmbus_common_ns = cg.esphome_ns.namespace("wmbus_common")
 WMBusCommon = wmbus_common_ns.class_("WMBusCommon", cg.Component)
@@ -31,6 +32,7 @@ CONFIG_SCHEMA = cv.Schema(
             lambda x: AVAILABLE_DRIVERS if x == "all" else x,
             {validate_driver},
         ),
+        cv.Optional(CONF_MANUFACTURER_NAMES, default=True): cv.boolean,
     }
 )
 
@@ -53,5 +55,8 @@ async def to_code(config):
     component.__class__ = WMBusComponentManifest
     component.exclude_drivers = AVAILABLE_DRIVERS - _registered_drivers
 
+    if not config[CONF_MANUFACTURER_NAMES]:
+        cg.add_build_flag("-DWMBUS_NO_MANUFACTURER_NAMES")
+
     var = cg.new_Pvariable(config[CONF_ID], sorted(_registered_drivers))
     await cg.register_component(var, config)
@@ -2,6 +2,10 @@
 #include "esphome/core/log.h"
 
 #include "_version.h"
+#include "manufacturer_specificities.h"
+#include "meters.h"
+
+#include <cinttypes>
 
 namespace esphome {
 namespace wmbus_common {
@@ -15,6 +19,17 @@ public:
     ESP_LOGCONFIG(TAG, "  Loaded drivers:");
     for (const auto &driver : this->drivers_)
       ESP_LOGCONFIG(TAG, "   %s", driver.c_str());
+    ESP_LOGCONFIG(TAG, "  Field name cache: %zu hits, %zu misses",
+                  FieldInfo::fieldNameCacheHits(),
+                  FieldInfo::fieldNameCacheMisses());
+    // Shared by all Izar and Sharky meters.
+    auto &diehl = diehlKeyTrialStats();
+    if (diehl.attempts > 0)
+      ESP_LOGCONFIG(TAG,
+                    "  Diehl LFSR key trials: %" PRIu32
+                    ", remembered key hits %" PRIu32 ", misses %" PRIu32,
+                    diehl.attempts, diehl.remembered_hits,
+                    diehl.remembered_misses);
   }
 
 protected:
@@ -25,7 +25,7 @@
 std::vector<std::string>
 splitSequenceOfAddressExpressionsAtCommas(const std::string &mes);
 bool isValidMatchExpression(const std::string &s, bool *has_wildcard);
-bool doesIdMatchExpression(const std::string &id, std::string match_rule);
+bool doesIdMatchExpression(const std::string &id, const std::string &match);
 bool doesAddressMatchExpressions(
     Address &address, std::vector<AddressExpression> &address_expressions,
     bool *used_wildcard, bool *filtered_out, bool *required_found,
@@ -148,44 +148,29 @@ std::vector<AddressExpression> splitAddressExpressions(const std::string &aes) {
   return r;
 }
 
-bool doesIdMatchExpression(const std::string &s, std::string match) {
-  std::string id = s;
+bool doesIdMatchExpression(const std::string &id, const std::string &match) {
   if (id.length() == 0)
     return false;
 
   // Here we assume that the match expression has been
   // verified to be valid.
-  bool can_match = true;
-
   // Now match bcd/hex until end of id, or '*' in match.
-  while (id.length() > 0 && match.length() > 0 && match.front() != '*') {
-    if (id.front() != match.front()) {
+  size_t i = 0;
+  while (i < id.length() && i < match.length() && match[i] != '*') {
+    if (id[i] != match[i]) {
       // We hit a difference, it cannot match.
-      can_match = false;
-      break;
+      return false;
     }
-    id.erase(0, 1);
-    match.erase(0, 1);
-  }
-
-  bool wildcard_used = false;
-  if (match.length() && match.front() == '*') {
-    wildcard_used = true;
-    match.erase(0, 1);
+    i++;
   }
 
-  if (can_match) {
-    // Ok, now the match expression should be empty.
-    // If wildcard is true, then the id can still have digits,
-    // otherwise it must also be empty.
-    if (wildcard_used) {
-      can_match = match.length() == 0;
-    } else {
-      can_match = match.length() == 0 && id.length() == 0;
-    }
-  }
+  // Ok, now the match expression should be empty.
+  // If a wildcard is used, then the id can still have digits,
+  // otherwise it must also be empty.
+  if (i < match.length() && match[i] == '*')
+    return i + 1 == match.length();
 
-  return can_match;
+  return i == match.length() && i == id.length();
 }
 
 bool hasWildCard(const std::string &mes) {
@@ -206,6 +191,47 @@ bool AddressExpression::match(const std::string &i, uint16_t m, uchar v,
   return true;
 }
 
+bool AddressExpression::match(const Address &a) {
+  if (!(mfct == 0xffff || mfct == a.mfct))
+    return false;
+  if (!(version == 0xff || version == a.version))
+    return false;
+  if (!(type == 0xff || type == a.type))
+    return false;
+  if (has_id_bits && a.has_id_bits)
+    return (a.id_bits & id_mask) == id_value;
+
+  return doesIdMatchExpression(a.id, id);
+}
+
+void AddressExpression::compileId() {
+  has_id_bits = false;
+  id_value = 0;
+  id_mask = 0;
+  if (mbus_primary)
+    return;
+
+  // The ids decoded from telegrams are always 8 lower case hex digits,
+  // anything else is left to the string matching.
+  uint32_t value = 0;
+  size_t n = 0;
+  while (n < id.length() && n < 8 &&
+         ((id[n] >= '0' && id[n] <= '9') || (id[n] >= 'a' && id[n] <= 'f'))) {
+    value = value << 4 | (id[n] <= '9' ? id[n] - '0' : id[n] - 'a' + 10);
+    n++;
+  }
+  bool wildcard = n < id.length() && id[n] == '*';
+  if (n + (wildcard ? 1 : 0) != id.length())
+    return;
+  if (!wildcard && n != 8)
+    return;
+
+  int shift = 4 * (8 - n);
+  id_value = shift == 32 ? 0 : value << shift;
+  id_mask = shift == 32 ? 0 : 0xffffffffu << shift;
+  has_id_bits = true;
+}
+
 void AddressExpression::trimToIdentity(IdentityMode im, Address &a) {
   switch (im) {
   case IdentityMode::FULL:
@@ -232,6 +258,7 @@ void AddressExpression::trimToIdentity(IdentityMode im, Address &a) {
   default:
     break;
   }
+  compileId();
 }
 
 bool AddressExpression::parse(const std::string &in) {
@@ -254,6 +281,7 @@ bool AddressExpression::parse(const std::string &in) {
   type = 0xff;
   version = 0xff;
   filter_out = false;
+  has_id_bits = false;
 
   if (s.size() == 0)
     return false;
@@ -319,6 +347,7 @@ bool AddressExpression::parse(const std::string &in) {
       return false;
     type = data[0];
 
+    compileId();
     return true;
   }
 
@@ -374,6 +403,7 @@ bool AddressExpression::parse(const std::string &in) {
     }
   }
 
+  compileId();
   return true;
 }
 
@@ -464,6 +494,9 @@ void Address::decodeMfctFirst(const std::vector<uchar>::iterator &pos) {
   mfct = *(pos + 1) << 8 | *(pos + 0);
   id = tostrprintf("%02x%02x%02x%02x", *(pos + 5), *(pos + 4), *(pos + 3),
                    *(pos + 2));
+  id_bits = (uint32_t)*(pos + 5) << 24 | *(pos + 4) << 16 | *(pos + 3) << 8 |
+            *(pos + 2);
+  has_id_bits = true;
   version = *(pos + 6);
   type = *(pos + 7);
 }
@@ -471,6 +504,9 @@ void Address::decodeMfctFirst(const std::vector<uchar>::iterator &pos) {
 void Address::decodeIdFirst(const std::vector<uchar>::iterator &pos) {
   id = tostrprintf("%02x%02x%02x%02x", *(pos + 3), *(pos + 2), *(pos + 1),
                    *(pos + 0));
+  id_bits = (uint32_t)*(pos + 3) << 24 | *(pos + 2) << 16 | *(pos + 1) << 8 |
+            *(pos + 0);
+  has_id_bits = true;
   mfct = *(pos + 5) << 8 | *(pos + 4);
   version = *(pos + 6);
   type = *(pos + 7);
@@ -536,7 +572,7 @@ bool doesAddressMatchExpressions(
     if (is_required)
       *required_found = true;
 
-    bool m = ae.match(address.id, address.mfct, address.version, address.type);
+    bool m = ae.match(address);
 
     if (is_negative_rule) {
       if (m)
@@ -605,6 +641,9 @@ void AddressExpression::clear() {
   mfct = 0xffff;
   version = 0xff;
   type = 0xff;
+  id_value = 0;
+  id_mask = 0;
+  has_id_bits = false;
 }
 
 void AddressExpression::appendIdentity(IdentityMode im,
@@ -43,6 +43,10 @@ struct Address {
   uint16_t mfct{};
   uchar type{};
   uchar version{};
+  // The id as a number, 0x1234abcd for 1234abcd. Only valid for ids decoded
+  // from a telegram, not for mbus primary addresses like p1.
+  uint32_t id_bits{};
+  bool has_id_bits{};
 
   void decodeMfctFirst(const std::vector<uchar>::iterator &pos);
   void decodeIdFirst(const std::vector<uchar>::iterator &pos);
@@ -73,14 +77,25 @@ struct AddressExpression {
   bool filter_out{}; // Telegrams matching this rule should be filtered out!
   bool required{};   // If true, then this address expression must be matched!
 
+  // The id compiled into a value and mask over the numeric id, 12* becomes
+  // value 0x12000000 mask 0xff000000. Ids that cannot be compiled, like
+  // mbus primary addresses, are matched using the id string.
+  uint32_t id_value{};
+  uint32_t id_mask{};
+  bool has_id_bits{};
+
   AddressExpression() {}
   AddressExpression(Address &a)
-      : id(a.id), mfct(a.mfct), version(a.version), type(a.type) {}
+      : id(a.id), mfct(a.mfct), version(a.version), type(a.type) {
+    compileId();
+  }
   bool operator==(const AddressExpression &) const;
   void clear();
   void trimToIdentity(IdentityMode im, Address &a);
   bool parse(const std::string &s);
+  void compileId();
   bool match(const std::string &id, uint16_t mfct, uchar version, uchar type);
+  bool match(const Address &a);
   std::string str();
   static std::string
   concat(std::vector<AddressExpression> &address_expressions);
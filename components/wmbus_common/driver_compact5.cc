@@ -66,7 +66,7 @@ namespace
         // simple wrapped inside a wmbus telegram since the ci-field is 0xa2.
         // Which means that the entire payload is manufacturer specific.
 
-        std::map<std::string,std::pair<int,DVEntry>> vendor_values;
+        DVEntries vendor_values(t->arena);
         std::vector<uchar> content;
 
         t->extractPayload(&content);
@@ -81,8 +81,7 @@ namespace
         strprintf(&prevs, "%02x%02x", prev_lo, prev_hi);
         int offset = t->parsed.size()+3;
         vendor_values["0215"] = { offset, DVEntry(offset, DifVifKey("0215"), MeasurementType::Instantaneous, 0x15, {}, {}, 0, 0, 0, prevs) };
-        Explanation pe(offset, 2, prevs, KindOfData::CONTENT, Understanding::FULL);
-        t->explanations.push_back(pe);
+        t->explanations.emplace_back(offset, 2, prevs, KindOfData::CONTENT, Understanding::FULL);
         t->addMoreExplanation(offset, " energy used in previous billing period (%f KWH)", prev);
 
         uchar curr_lo = content[7];
@@ -93,8 +92,7 @@ namespace
         strprintf(&currs, "%02x%02x", curr_lo, curr_hi);
         offset = t->parsed.size()+7;
         vendor_values["0215"] = { offset, DVEntry(offset, DifVifKey("0215"), MeasurementType::Instantaneous, 0x15, {}, {}, 0, 0, 0, currs) };
-        Explanation ce(offset, 2, currs, KindOfData::CONTENT, Understanding::FULL);
-        t->explanations.push_back(ce);
+        t->explanations.emplace_back(offset, 2, currs, KindOfData::CONTENT, Understanding::FULL);
         t->addMoreExplanation(offset, " energy used in current billing period (%f KWH)", curr);
 
         double total_energy_kwh = prev+curr;
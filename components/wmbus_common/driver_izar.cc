@@ -50,7 +50,7 @@ namespace
         std::string currentAlarmsText(IzarAlarms &alarms);
         std::string previousAlarmsText(IzarAlarms &alarms);
 
-        std::vector<uchar> decodePrios(const std::vector<uchar> &origin, const std::vector<uchar> &payload, uint32_t key);
+        std::vector<uchar> decodePrios(const std::vector<uchar> &origin, const std::vector<uchar> &payload);
 
         std::vector<uint32_t> keys;
     };
@@ -190,12 +190,7 @@ namespace
         t->extractFrame(&frame);
         std::vector<uchar> origin = t->original.empty() ? frame : t->original;
 
-        std::vector<uchar> decoded_content;
-        for (auto& key : keys) {
-            decoded_content = decodePrios(origin, frame, key);
-            if (!decoded_content.empty())
-                break;
-        }
+        std::vector<uchar> decoded_content = decodePrios(origin, frame);
 
         debug("(izar) Decoded PRIOS data: %s\n", bin2hex(decoded_content).c_str());
 
@@ -279,9 +274,9 @@ namespace
         setStringValue("previous_alarms", previousAlarmsText(alarms));
     }
 
-    std::vector<uchar> Driver::decodePrios(const std::vector<uchar> &origin, const std::vector<uchar> &frame, uint32_t key)
+    std::vector<uchar> Driver::decodePrios(const std::vector<uchar> &origin, const std::vector<uchar> &frame)
     {
-        return decodeDiehlLfsr(origin, frame, key, DiehlLfsrCheckMethod::HEADER_1_BYTE, 0x4B);
+        return decodeDiehlLfsrWithKeys(origin, frame, keys, DiehlLfsrCheckMethod::HEADER_1_BYTE, 0x4B);
     }
 }
 
@@ -60,7 +60,7 @@ namespace
         // simple wrapped inside a wmbus telegram since the ci-field is 0xa2.
         // Which means that the entire payload is manufacturer specific.
 
-        std::map<std::string,std::pair<int,DVEntry>> vendor_values;
+        DVEntries vendor_values(t->arena);
         std::vector<uchar> content;
 
         t->extractPayload(&content);
@@ -74,7 +74,7 @@ namespace
         strprintf(&prevs, "%02x%02x", prev_lo, prev_hi);
         int offset = t->parsed.size()+3;
         vendor_values["0215"] = { offset, DVEntry(offset, DifVifKey("0215"), MeasurementType::Instantaneous, 0x15, {}, 0, 0, 0, prevs) };
-        t->explanations.push_back(Explanation(offset, 2, prevs, KindOfData::CONTENT, Understanding::FULL));
+        t->explanations.emplace_back(offset, 2, prevs, KindOfData::CONTENT, Understanding::FULL);
         t->addMoreExplanation(offset, " prev consumption (%f m3)", prev);
         */
 
@@ -87,7 +87,7 @@ namespace
         strprintf(&currs, "%02x%02x", curr_lo, curr_hi);
         offset = t->parsed.size()+7;
         vendor_values["0215"] = { offset, DVEntry(offset, DifVifKey("0215"), MeasurementType::Instantaneous, 0x15, {}, 0, 0, 0, currs) };
-        t->explanations.push_back(Explanation(offset, 2, currs, KindOfData::CONTENT, Understanding::FULL));
+        t->explanations.emplace_back(offset, 2, currs, KindOfData::CONTENT, Understanding::FULL);
         t->addMoreExplanation(offset, " curr consumption (%f m3)", curr);
         */
 
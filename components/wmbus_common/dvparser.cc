@@ -180,9 +180,8 @@ bool loadFormatBytesFromSignature(uint16_t format_signature,
 
 bool parseDV(Telegram *t, std::vector<uchar> &databytes,
              std::vector<uchar>::iterator data, size_t data_len,
-             std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-             std::vector<uchar>::iterator *format, size_t format_len,
-             uint16_t *format_hash) {
+             DVEntries *dv_entries, std::vector<uchar>::iterator *format,
+             size_t format_len, uint16_t *format_hash) {
   std::map<std::string, int> dv_count;
   std::vector<uchar> format_bytes;
   std::vector<uchar> id_bytes;
@@ -614,20 +613,18 @@ bool parseDV(Telegram *t, std::vector<uchar> &databytes,
   return true;
 }
 
-bool hasKey(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-            std::string key) {
+bool hasKey(DVEntries *dv_entries, std::string key) {
   return dv_entries->count(key) > 0;
 }
 
 bool findKey(MeasurementType mit, VIFRange vif_range, StorageNr storagenr,
-             TariffNr tariffnr, std::string *key,
-             std::map<std::string, std::pair<int, DVEntry>> *dv_entries) {
+             TariffNr tariffnr, std::string *key, DVEntries *dv_entries) {
   return findKeyWithNr(mit, vif_range, storagenr, tariffnr, 1, key, dv_entries);
 }
 
 bool findKeyWithNr(MeasurementType mit, VIFRange vif_range, StorageNr storagenr,
                    TariffNr tariffnr, int nr, std::string *key,
-                   std::map<std::string, std::pair<int, DVEntry>> *dv_entries) {
+                   DVEntries *dv_entries) {
   /*debug("(dvparser) looking for type=%s vifrange=%s storagenr=%d
     tariffnr=%d\n", measurementTypeName(mit).c_str(), toString(vif_range),
     storagenr.intValue(), tariffnr.intValue());*/
@@ -708,8 +705,8 @@ void extractDV(std::string &s, uchar *dif, int *vif, bool *has_difes,
   }
 }
 
-bool extractDVuint8(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-                    std::string key, int *offset, uchar *value) {
+bool extractDVuint8(DVEntries *dv_entries, std::string key, int *offset,
+                    uchar *value) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract uint8 from non-existant key "
             "\"%s\"\n",
@@ -728,8 +725,8 @@ bool extractDVuint8(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
   return true;
 }
 
-bool extractDVuint16(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-                     std::string key, int *offset, uint16_t *value) {
+bool extractDVuint16(DVEntries *dv_entries, std::string key, int *offset,
+                     uint16_t *value) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract uint16 from non-existant key "
             "\"%s\"\n",
@@ -748,8 +745,8 @@ bool extractDVuint16(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
   return true;
 }
 
-bool extractDVuint24(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-                     std::string key, int *offset, uint32_t *value) {
+bool extractDVuint24(DVEntries *dv_entries, std::string key, int *offset,
+                     uint32_t *value) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract uint24 from non-existant key "
             "\"%s\"\n",
@@ -768,8 +765,8 @@ bool extractDVuint24(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
   return true;
 }
 
-bool extractDVuint32(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-                     std::string key, int *offset, uint32_t *value) {
+bool extractDVuint32(DVEntries *dv_entries, std::string key, int *offset,
+                     uint32_t *value) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract uint32 from non-existant key "
             "\"%s\"\n",
@@ -789,9 +786,8 @@ bool extractDVuint32(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
   return true;
 }
 
-bool extractDVdouble(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-                     std::string key, int *offset, double *value,
-                     bool auto_scale, bool force_unsigned) {
+bool extractDVdouble(DVEntries *dv_entries, std::string key, int *offset,
+                     double *value, bool auto_scale, bool force_unsigned) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract double from non-existant key "
             "\"%s\"\n",
@@ -1033,8 +1029,8 @@ bool DVEntry::extractDouble(double *out, bool auto_scale, bool force_unsigned) {
   return true;
 }
 
-bool extractDVlong(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-                   std::string key, int *offset, uint64_t *out) {
+bool extractDVlong(DVEntries *dv_entries, std::string key, int *offset,
+                   uint64_t *out) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract long from non-existant key "
             "\"%s\"\n",
@@ -1200,9 +1196,8 @@ bool DVEntry::extractLong(uint64_t *out) {
   return true;
 }
 
-bool extractDVHexString(
-    std::map<std::string, std::pair<int, DVEntry>> *dv_entries, std::string key,
-    int *offset, std::string *value) {
+bool extractDVHexString(DVEntries *dv_entries, std::string key, int *offset,
+                        std::string *value) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract std::string from non-existant "
             "key \"%s\"\n",
@@ -1217,9 +1212,8 @@ bool extractDVHexString(
   return true;
 }
 
-bool extractDVReadableString(
-    std::map<std::string, std::pair<int, DVEntry>> *dv_entries, std::string key,
-    int *offset, std::string *out) {
+bool extractDVReadableString(DVEntries *dv_entries, std::string key,
+                             int *offset, std::string *out) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract std::string from non-existant "
             "key \"%s\"\n",
@@ -1331,8 +1325,8 @@ bool extractTime(uchar hi, uchar lo, struct tm *date) {
   return true;
 }
 
-bool extractDVdate(std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-                   std::string key, int *offset, struct tm *out) {
+bool extractDVdate(DVEntries *dv_entries, std::string key, int *offset,
+                   struct tm *out) {
   if ((*dv_entries).count(key) == 0) {
     verbose("(dvparser) warning: cannot extract date from non-existant key "
             "\"%s\"\n",
@@ -24,6 +24,7 @@
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory_resource>
 #include <set>
 #include <time.h>
 #include <vector>
@@ -495,13 +496,17 @@ struct FieldMatcher {
 bool loadFormatBytesFromSignature(uint16_t format_signature,
                                   std::vector<uchar> *format_bytes);
 
+// The dv entries of a telegram mapped from their key to their offset and
+// content. The map allocates its nodes from the memory resource it is given,
+// which for a parsed telegram is the telegram's arena.
+typedef std::pmr::map<std::string, std::pair<int, DVEntry>> DVEntries;
+
 struct Telegram;
 
 bool parseDV(Telegram *t, std::vector<uchar> &databytes,
              std::vector<uchar>::iterator data, size_t data_len,
-             std::map<std::string, std::pair<int, DVEntry>> *dv_entries,
-             std::vector<uchar>::iterator *format = NULL, size_t format_len = 0,
-             uint16_t *format_hash = NULL);
+             DVEntries *dv_entries, std::vector<uchar>::iterator *format = NULL,
+             size_t format_len = 0, uint16_t *format_hash = NULL);
 
 // Instead of using a hardcoded difvif as key in the extractDV... below,
 // find an existing difvif entry in the values based on the desired value
@@ -509,51 +514,48 @@ bool parseDV(Telegram *t, std::vector<uchar> &databytes,
 // ExternalTemperature etc in combination with the storagenr. (Later I will add
 // tariff/subunit)
 bool findKey(MeasurementType mt, VIFRange vi, StorageNr storagenr,
-             TariffNr tariffnr, std::string *key,
-             std::map<std::string, std::pair<int, DVEntry>> *values);
+             TariffNr tariffnr, std::string *key, DVEntries *values);
 // Some meters have multiple identical DIF/VIF values! Meh, they are not using
 // storage nrs or tariff nrs. So here we can pick for example nr 2 of an
 // identical set if DIF/VIF values. Nr 1 means the first found value.
 bool findKeyWithNr(MeasurementType mt, VIFRange vi, StorageNr storagenr,
                    TariffNr tariffnr, int indexnr, std::string *key,
-                   std::map<std::string, std::pair<int, DVEntry>> *values);
+                   DVEntries *values);
 
-bool hasKey(std::map<std::string, std::pair<int, DVEntry>> *values,
-            std::string key);
+bool hasKey(DVEntries *values, std::string key);
 
-bool extractDVuint8(std::map<std::string, std::pair<int, DVEntry>> *values,
-                    std::string key, int *offset, uchar *value);
+bool extractDVuint8(DVEntries *values, std::string key, int *offset,
+                    uchar *value);
 
-bool extractDVuint16(std::map<std::string, std::pair<int, DVEntry>> *values,
-                     std::string key, int *offset, uint16_t *value);
+bool extractDVuint16(DVEntries *values, std::string key, int *offset,
+                     uint16_t *value);
 
-bool extractDVuint24(std::map<std::string, std::pair<int, DVEntry>> *values,
-                     std::string key, int *offset, uint32_t *value);
+bool extractDVuint24(DVEntries *values, std::string key, int *offset,
+                     uint32_t *value);
 
-bool extractDVuint32(std::map<std::string, std::pair<int, DVEntry>> *values,
-                     std::string key, int *offset, uint32_t *value);
+bool extractDVuint32(DVEntries *values, std::string key, int *offset,
+                     uint32_t *value);
 
 // All values are scaled according to the vif and wmbusmeters scaling defaults.
-bool extractDVdouble(std::map<std::string, std::pair<int, DVEntry>> *values,
-                     std::string key, int *offset, double *value,
-                     bool auto_scale = true, bool force_unsigned = false);
+bool extractDVdouble(DVEntries *values, std::string key, int *offset,
+                     double *value, bool auto_scale = true,
+                     bool force_unsigned = false);
 
 // Extract a value without scaling. Works for 8bits to 64 bits, binary and bcd.
-bool extractDVlong(std::map<std::string, std::pair<int, DVEntry>> *values,
-                   std::string key, int *offset, uint64_t *value);
+bool extractDVlong(DVEntries *values, std::string key, int *offset,
+                   uint64_t *value);
 
 // Just copy the raw hex data into the string, not reversed or anything.
-bool extractDVHexString(std::map<std::string, std::pair<int, DVEntry>> *values,
-                        std::string key, int *offset, std::string *value);
+bool extractDVHexString(DVEntries *values, std::string key, int *offset,
+                        std::string *value);
 
 // Read the content and attempt to reverse and transform it into a readble
 // string based on the dif information.
-bool extractDVReadableString(
-    std::map<std::string, std::pair<int, DVEntry>> *values, std::string key,
-    int *offset, std::string *value);
+bool extractDVReadableString(DVEntries *values, std::string key, int *offset,
+                             std::string *value);
 
-bool extractDVdate(std::map<std::string, std::pair<int, DVEntry>> *values,
-                   std::string key, int *offset, struct tm *value);
+bool extractDVdate(DVEntries *values, std::string key, int *offset,
+                   struct tm *value);
 
 const std::string &availableVIFRanges();
 const std::string &availableVIFCombinables();
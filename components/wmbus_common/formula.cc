@@ -158,6 +158,141 @@ double NumericFormulaSquareRoot::calculate(SIUnit to_siunit) {
   return v;
 }
 
+void FormulaProgram::emitPush(double v) {
+  FormulaInstruction i{FormulaOp::PUSH};
+  i.value = v;
+  code.push_back(i);
+  stack_size++;
+  if (stack_size > max_stack_size)
+    max_stack_size = stack_size;
+}
+
+void FormulaProgram::emitField(int index, Unit field_unit, const SIUnit &to) {
+  FormulaInstruction i{FormulaOp::FIELD};
+  i.index = index;
+  code.push_back(i);
+  stack_size++;
+  if (stack_size > max_stack_size)
+    max_stack_size = stack_size;
+  emitConvert(toSIUnit(field_unit), to);
+}
+
+void FormulaProgram::emitCounter(DVEntryCounterType ct, const SIUnit &to) {
+  FormulaInstruction i{FormulaOp::COUNTER};
+  i.index = (int)ct;
+  code.push_back(i);
+  stack_size++;
+  if (stack_size > max_stack_size)
+    max_stack_size = stack_size;
+  emitConvert(toSIUnit(Unit::COUNTER), to);
+}
+
+void FormulaProgram::emitConvert(const SIUnit &from, const SIUnit &to) {
+  FormulaInstruction i{FormulaOp::CONVERT};
+  if (!from.conversionTo(to, &i.conversion)) {
+    // Same as convertTo, an impossible conversion produces nan.
+    i.conversion.mul = std::numeric_limits<double>::quiet_NaN();
+  }
+  if (!i.conversion.isIdentity())
+    code.push_back(i);
+}
+
+void FormulaProgram::emitMathOp(MathOp op, const SIUnit &left,
+                                const SIUnit &right, const SIUnit &to) {
+  // The resulting unit only depends on the operand units.
+  SIUnit v_siunit(Unit::COUNTER);
+  bool ok = left.mathOpTo(op, 0, 0, right, &v_siunit, NULL);
+
+  FormulaInstruction i{FormulaOp::MATHOP};
+  i.math_op = op;
+  if (ok && left.exp() == right.exp()) {
+    // The common case, convert left into the right unit and add/subtract.
+    i.op = op == MathOp::ADD ? FormulaOp::ADD : FormulaOp::SUB;
+    left.conversionTo(right, &i.conversion);
+  } else {
+    i.index = mathop_units.size();
+    mathop_units.push_back({left, right});
+  }
+  code.push_back(i);
+  stack_size--;
+  emitConvert(v_siunit, to);
+}
+
+void FormulaProgram::emitBinary(FormulaOp op) {
+  code.push_back(FormulaInstruction{op});
+  stack_size--;
+}
+
+void FormulaProgram::emitUnary(FormulaOp op) {
+  code.push_back(FormulaInstruction{op});
+}
+
+void NumericFormulaConstant::compile(FormulaProgram &p, const SIUnit &to) {
+  p.emitPush(calculate(to));
+}
+
+void NumericFormulaMeterField::compile(FormulaProgram &p, const SIUnit &to) {
+  Meter *m = formula()->meter();
+  FieldInfo *fi = m == NULL ? NULL : m->findFieldInfo(vname_, quantity_);
+
+  if (fi == NULL) {
+    p.unresolved = true;
+    p.emitPush(std::numeric_limits<double>::quiet_NaN());
+    return;
+  }
+
+  // Meters of the same driver share the same field info layout, therefore
+  // the index is valid for any meter that calculates this formula.
+  int index = fi - &m->fieldInfos()[0];
+  p.emitField(index, fi->displayUnit(), to);
+}
+
+void NumericFormulaDVEntryField::compile(FormulaProgram &p,
+                                         const SIUnit &to) {
+  p.emitCounter(counter_, to);
+}
+
+void NumericFormulaAddition::compile(FormulaProgram &p, const SIUnit &to) {
+  left_->compile(p, left_->siunit());
+  right_->compile(p, right_->siunit());
+  p.emitMathOp(MathOp::ADD, left_->siunit(), right_->siunit(), to);
+}
+
+void NumericFormulaSubtraction::compile(FormulaProgram &p, const SIUnit &to) {
+  left_->compile(p, left_->siunit());
+  right_->compile(p, right_->siunit());
+  p.emitMathOp(MathOp::SUB, left_->siunit(), right_->siunit(), to);
+}
+
+void NumericFormulaMultiplication::compile(FormulaProgram &p,
+                                           const SIUnit &to) {
+  left_->compile(p, left_->siunit());
+  right_->compile(p, right_->siunit());
+  p.emitBinary(FormulaOp::MUL);
+  p.emitConvert(siunit(), to);
+}
+
+void NumericFormulaDivision::compile(FormulaProgram &p, const SIUnit &to) {
+  left_->compile(p, left_->siunit());
+  right_->compile(p, right_->siunit());
+  p.emitBinary(FormulaOp::DIV);
+  p.emitConvert(siunit(), to);
+}
+
+void NumericFormulaExponentiation::compile(FormulaProgram &p,
+                                           const SIUnit &to) {
+  left_->compile(p, to);
+  right_->compile(p, to);
+  p.emitBinary(FormulaOp::POW);
+  p.emitConvert(siunit(), to);
+}
+
+void NumericFormulaSquareRoot::compile(FormulaProgram &p, const SIUnit &to) {
+  inner_->compile(p, inner_->siunit());
+  p.emitUnary(FormulaOp::SQRT);
+  p.emitConvert(siunit(), to);
+}
+
 const char *toString(TokenType tt) {
   switch (tt) {
   case TokenType::SPACE:
@@ -236,6 +371,8 @@ void FormulaImplementation::clear() {
   formula_ = "";
   dventry_ = NULL;
   meter_ = NULL;
+  program_valid_ = false;
+  uses_meter_fields_ = false;
 }
 
 bool is_letter(char c) { return c >= 'a' && c <= 'z'; }
@@ -929,7 +1066,85 @@ double FormulaImplementation::calculate(Unit to, DVEntry *dve, Meter *m) {
     return std::nan("");
   }
 
-  return topOp()->calculate(toSIUnit(to));
+  if (!program_valid_ || program_unit_ != to)
+    compile(to);
+
+  return execute();
+}
+
+void FormulaImplementation::compile(Unit to) {
+  program_ = FormulaProgram();
+  topOp()->compile(program_, toSIUnit(to));
+  stack_.resize(program_.max_stack_size);
+  program_unit_ = to;
+  program_valid_ = !program_.unresolved;
+
+  debug("(formula) compiled \"%s\" into %zu instructions\n", formula_.c_str(),
+        program_.code.size());
+}
+
+double FormulaImplementation::execute() {
+  double *sp = stack_.data();
+
+  for (FormulaInstruction &i : program_.code) {
+    switch (i.op) {
+    case FormulaOp::PUSH:
+      *sp++ = i.value;
+      break;
+    case FormulaOp::FIELD: {
+      if (meter_ == NULL ||
+          (size_t)i.index >= meter_->fieldInfos().size()) {
+        *sp++ = std::numeric_limits<double>::quiet_NaN();
+        break;
+      }
+      FieldInfo *fi = &meter_->fieldInfos()[i.index];
+      *sp++ = meter_->getNumericValue(fi, fi->displayUnit());
+      break;
+    }
+    case FormulaOp::COUNTER:
+      if (dventry_ == NULL)
+        *sp++ = std::numeric_limits<double>::quiet_NaN();
+      else
+        *sp++ = dventry_->getCounter((DVEntryCounterType)i.index);
+      break;
+    case FormulaOp::CONVERT:
+      sp[-1] = i.conversion.apply(sp[-1]);
+      break;
+    case FormulaOp::ADD:
+      sp--;
+      sp[-1] = i.conversion.apply(sp[-1]) + sp[0];
+      break;
+    case FormulaOp::SUB:
+      sp--;
+      sp[-1] = i.conversion.apply(sp[-1]) - sp[0];
+      break;
+    case FormulaOp::MATHOP: {
+      sp--;
+      std::pair<SIUnit, SIUnit> &u = program_.mathop_units[i.index];
+      double v{};
+      u.first.mathOpTo(i.math_op, sp[-1], sp[0], u.second, NULL, &v);
+      sp[-1] = v;
+      break;
+    }
+    case FormulaOp::MUL:
+      sp--;
+      sp[-1] = sp[-1] * sp[0];
+      break;
+    case FormulaOp::DIV:
+      sp--;
+      sp[-1] = sp[-1] / sp[0];
+      break;
+    case FormulaOp::POW:
+      sp--;
+      sp[-1] = pow(sp[-1], sp[0]);
+      break;
+    case FormulaOp::SQRT:
+      sp[-1] = sqrt(sp[-1]);
+      break;
+    }
+  }
+
+  return stack_[0];
 }
 
 void FormulaImplementation::doConstant(Unit u, double c) {
@@ -1031,6 +1246,7 @@ void FormulaImplementation::doMeterField(Unit u, FieldInfo *fi) {
   SIUnit to_si_unit = toSIUnit(u);
   assert(from_si_unit.convertTo(0, to_si_unit, NULL));
 
+  uses_meter_fields_ = true;
   pushOp(new NumericFormulaMeterField(this, u, fi->vname(), fi->xuantity()));
 }
 
@@ -1202,6 +1418,14 @@ bool StringInterpolatorImplementation::parse(Meter *m, const std::string &f) {
   return true;
 }
 
+bool StringInterpolatorImplementation::usesMeterFields() {
+  for (auto &f : formulas_) {
+    if (f->usesMeterFields())
+      return true;
+  }
+  return false;
+}
+
 std::string StringInterpolatorImplementation::apply(Meter *m, DVEntry *dve) {
   std::string result;
   size_t s = 0;
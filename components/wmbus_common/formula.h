@@ -51,6 +51,8 @@ struct Formula {
   virtual void setMeter(Meter *m) = 0;
   // Specify which dventry to read counter fields from.
   virtual void setDVEntry(DVEntry *dve) = 0;
+  // Returns true if the formula reads any meter fields.
+  virtual bool usesMeterFields() = 0;
 
   virtual ~Formula() = 0;
 };
@@ -76,6 +78,11 @@ struct StringInterpolator {
 
   */
   virtual std::string apply(Meter *m, DVEntry *dve) = 0;
+  /**
+     usesMeterFields: Returns true if any formula reads meter fields, if not
+     then the result of apply only depends on the dve counters.
+  */
+  virtual bool usesMeterFields() = 0;
 
   virtual ~StringInterpolator() = 0;
 };
@@ -25,12 +25,64 @@
 
 struct FormulaImplementation;
 
+enum class FormulaOp {
+  PUSH,    // Push value.
+  FIELD,   // Push the meter field at index in the field infos.
+  COUNTER, // Push the dventry counter given by index.
+  CONVERT, // Convert the top of the stack.
+  ADD,     // Convert the left operand, then add.
+  SUB,     // Convert the left operand, then subtract.
+  MATHOP,  // Fallback for timestamp arithmetic, uses SIUnit::mathOpTo.
+  MUL,
+  DIV,
+  POW,
+  SQRT
+};
+
+struct FormulaInstruction {
+  FormulaOp op;
+  // FIELD: index into the meter field infos.
+  // COUNTER: the DVEntryCounterType.
+  // MATHOP: index into the mathop_units of the program.
+  int index{};
+  MathOp math_op{};
+  double value{};
+  SIConversion conversion;
+
+  explicit FormulaInstruction(FormulaOp o) : op(o) {}
+};
+
+// A formula tree flattened into a program for a small stack machine. All unit
+// conversions between the nodes have been resolved into plain constants when
+// compiling, the tree is only used for parsing and printing.
+struct FormulaProgram {
+  std::vector<FormulaInstruction> code;
+  std::vector<std::pair<SIUnit, SIUnit>> mathop_units;
+  size_t stack_size{};
+  size_t max_stack_size{};
+  // Set when a meter field could not be resolved, the program must then be
+  // compiled again when a meter is available.
+  bool unresolved{};
+
+  void emitPush(double v);
+  void emitField(int index, Unit field_unit, const SIUnit &to);
+  void emitCounter(DVEntryCounterType ct, const SIUnit &to);
+  void emitConvert(const SIUnit &from, const SIUnit &to);
+  void emitMathOp(MathOp op, const SIUnit &left, const SIUnit &right,
+                  const SIUnit &to);
+  void emitBinary(FormulaOp op);
+  void emitUnary(FormulaOp op);
+};
+
 struct NumericFormula {
   NumericFormula(FormulaImplementation *f, SIUnit u)
       : formula_(f), siunit_(u) {}
   SIUnit &siunit() { return siunit_; }
   // Calculate the formula and return the value in the given "to" unit.
   virtual double calculate(SIUnit to) = 0;
+  // Append instructions to the program that leaves the value in the given
+  // "to" unit on the stack.
+  virtual void compile(FormulaProgram &p, const SIUnit &to) = 0;
   virtual std::string str() = 0;
   virtual std::string tree() = 0;
   virtual ~NumericFormula() = 0;
@@ -46,6 +98,7 @@ struct NumericFormulaConstant : public NumericFormula {
   NumericFormulaConstant(FormulaImplementation *f, Unit u, double c)
       : NumericFormula(f, u), constant_(c) {}
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
   std::string str();
   std::string tree();
   ~NumericFormulaConstant();
@@ -60,6 +113,7 @@ struct NumericFormulaMeterField : public NumericFormula {
       : NumericFormula(f, u), vname_(v), quantity_(q) {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
   std::string str();
   std::string tree();
   ~NumericFormulaMeterField();
@@ -75,6 +129,7 @@ struct NumericFormulaDVEntryField : public NumericFormula {
       : NumericFormula(f, u), counter_(ct) {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
   std::string str();
   std::string tree();
   ~NumericFormulaDVEntryField();
@@ -109,6 +164,7 @@ struct NumericFormulaAddition : public NumericFormulaPair {
       : NumericFormulaPair(f, siu, a, b, "ADD", "+") {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
 
   ~NumericFormulaAddition();
 };
@@ -120,6 +176,7 @@ struct NumericFormulaSubtraction : public NumericFormulaPair {
       : NumericFormulaPair(f, siu, a, b, "SUB", "-") {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
 
   ~NumericFormulaSubtraction();
 };
@@ -131,6 +188,7 @@ struct NumericFormulaMultiplication : public NumericFormulaPair {
       : NumericFormulaPair(f, siu, a, b, "TIMES", "×") {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
 
   ~NumericFormulaMultiplication();
 };
@@ -142,6 +200,7 @@ struct NumericFormulaDivision : public NumericFormulaPair {
       : NumericFormulaPair(f, siu, a, b, "DIV", "÷") {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
 
   ~NumericFormulaDivision();
 };
@@ -153,6 +212,7 @@ struct NumericFormulaExponentiation : public NumericFormulaPair {
       : NumericFormulaPair(f, siu, a, b, "EXP", "^") {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
 
   ~NumericFormulaExponentiation();
 };
@@ -163,6 +223,7 @@ struct NumericFormulaSquareRoot : public NumericFormula {
       : NumericFormula(f, siu), inner_(std::move(inner)) {}
 
   double calculate(SIUnit to);
+  void compile(FormulaProgram &p, const SIUnit &to);
   std::string str();
   std::string tree();
 
@@ -217,6 +278,11 @@ struct FormulaImplementation : public Formula {
   SIUnit &siUnit();
   void setMeter(Meter *m);
   void setDVEntry(DVEntry *dve);
+  bool usesMeterFields() { return uses_meter_fields_; }
+  // Flatten the formula tree into program_ for the given unit.
+  void compile(Unit to);
+  // Run program_ using the current meter and dventry.
+  double execute();
 
   // Pushes a constant on the formula builder stack.
   void doConstant(Unit u, double c);
@@ -292,12 +358,19 @@ struct FormulaImplementation : public Formula {
 
 private:
   bool valid_ = true;
+  bool uses_meter_fields_ = false;
   std::vector<std::unique_ptr<NumericFormula>> op_stack_;
   std::vector<Token> tokens_;
   std::string formula_; // To be parsed.
   Meter *meter_;        // To be referenced when parsing and calculating.
   DVEntry *dventry_;    // To be referenced when calculating.
 
+  // The compiled formula, valid for program_unit_ when program_valid_ is set.
+  FormulaProgram program_;
+  Unit program_unit_ = Unit::Unknown;
+  bool program_valid_ = false;
+  std::vector<double> stack_;
+
   // Any errors during parsing are store here.
   std::vector<std::string> errors_;
 };
@@ -308,6 +381,7 @@ struct StringInterpolatorImplementation : public StringInterpolator {
   // historic_1_value"
   bool parse(Meter *m, const std::string &f);
   std::string apply(Meter *m, DVEntry *dve);
+  bool usesMeterFields();
   ~StringInterpolatorImplementation();
 
   // The strings store "historic_" "_value"
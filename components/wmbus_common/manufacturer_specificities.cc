@@ -19,6 +19,7 @@
 #include "manufacturer_specificities.h"
 #include "manufacturers.h"
 #include "meters.h"
+#include <algorithm>
 #include <cstring>
 #include <set>
 
@@ -30,6 +31,14 @@ std::set<int> diehl_manufacturers = {MANUFACTURER_DME, MANUFACTURER_EWT,
 #define PRIOS_DEFAULT_KEY1 "39BC8A10E66D83F8"
 #define PRIOS_DEFAULT_KEY2 "51728910E66D83F8"
 
+// Number of meter addresses for which the winning LFSR key is remembered
+#define DIEHL_KEY_CACHE_SIZE 16
+
+// Meter address -> key that decoded it, most recently used first. The key
+// itself is remembered, not its index, since callers pass different key lists.
+static std::vector<std::pair<uint64_t, uint32_t>> diehl_key_cache_;
+static DiehlKeyTrialStats diehl_key_trial_stats_;
+
 // Diehl: Is "A field" coded differently from standard?
 DiehlAddressTransformMethod
 mustTransformDiehlAddress(DiehlFrameInterpretation interpretation) {
@@ -208,6 +217,72 @@ std::vector<uchar> decodeDiehlLfsr(const std::vector<uchar> &origin,
   return decoded;
 }
 
+// Diehl: manufacturer and address fields exactly as sent over the air
+static uint64_t diehlKeyCacheAddress(const std::vector<uchar> &origin) {
+  uint64_t address = 0;
+  for (size_t i = 2; i < 10 && i < origin.size(); i++)
+    address = address << 8 | origin[i];
+  return address;
+}
+
+static void rememberDiehlKey(uint64_t address, uint32_t key) {
+  diehl_key_cache_.insert(diehl_key_cache_.begin(), {address, key});
+  if (diehl_key_cache_.size() > DIEHL_KEY_CACHE_SIZE)
+    diehl_key_cache_.pop_back();
+}
+
+std::vector<uchar> decodeDiehlLfsrWithKeys(const std::vector<uchar> &origin,
+                                           const std::vector<uchar> &frame,
+                                           const std::vector<uint32_t> &keys,
+                                           DiehlLfsrCheckMethod check_method,
+                                           uint32_t check_value) {
+  uint64_t address = diehlKeyCacheAddress(origin);
+  size_t remembered = keys.size();
+
+  auto cached = std::find_if(
+      diehl_key_cache_.begin(), diehl_key_cache_.end(),
+      [address](const std::pair<uint64_t, uint32_t> &e) {
+        return e.first == address;
+      });
+  if (cached != diehl_key_cache_.end()) {
+    remembered = std::find(keys.begin(), keys.end(), cached->second) -
+                 keys.begin();
+    diehl_key_cache_.erase(cached);
+  }
+
+  std::vector<uchar> decoded;
+  if (remembered < keys.size()) {
+    diehl_key_trial_stats_.attempts++;
+    decoded = decodeDiehlLfsr(origin, frame, keys[remembered], check_method,
+                              check_value);
+    if (!decoded.empty()) {
+      diehl_key_trial_stats_.remembered_hits++;
+      rememberDiehlKey(address, keys[remembered]);
+      return decoded;
+    }
+    diehl_key_trial_stats_.remembered_misses++;
+    debug("(diehl) remembered key %zu failed, trying all keys\n", remembered);
+  }
+
+  for (size_t i = 0; i < keys.size(); i++) {
+    if (i == remembered)
+      continue;
+    diehl_key_trial_stats_.attempts++;
+    decoded = decodeDiehlLfsr(origin, frame, keys[i], check_method,
+                              check_value);
+    if (!decoded.empty()) {
+      rememberDiehlKey(address, keys[i]);
+      break;
+    }
+  }
+
+  return decoded;
+}
+
+const DiehlKeyTrialStats &diehlKeyTrialStats() {
+  return diehl_key_trial_stats_;
+}
+
 uint32_t uint32FromBytes(const std::vector<uchar> &data, int offset,
                          bool reverse) {
   if (reverse)
@@ -278,14 +353,9 @@ bool decryptDielhRealData(Telegram *t, std::vector<uchar> &frame,
   std::vector<uint32_t> keys;
   initializeDiehlDefaultKeySupport(confidentiality_key, keys);
 
-  std::vector<uchar> decoded_content;
-  for (auto &key : keys) {
-    decoded_content = decodeDiehlLfsr(
-        t->original.empty() ? frame : t->original, frame, key,
-        DiehlLfsrCheckMethod::CHECKSUM_AND_0XEF, frame[14] & 0xEF);
-    if (!decoded_content.empty())
-      break;
-  }
+  std::vector<uchar> decoded_content = decodeDiehlLfsrWithKeys(
+      t->original.empty() ? frame : t->original, frame, keys,
+      DiehlLfsrCheckMethod::CHECKSUM_AND_0XEF, frame[14] & 0xEF);
 
   if (decoded_content.empty()) {
     if (!t->isSimulated() && t->parserWarns()) {
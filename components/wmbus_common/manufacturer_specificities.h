@@ -48,6 +48,23 @@ std::vector<uchar> decodeDiehlLfsr(const std::vector<uchar> &origin,
                                    DiehlLfsrCheckMethod check_method,
                                    uint32_t check_value);
 
+// Diehl: decode LFSR encrypted data trying each key in turn, starting with the
+// key that last decoded a telegram from the same meter address
+std::vector<uchar> decodeDiehlLfsrWithKeys(const std::vector<uchar> &origin,
+                                           const std::vector<uchar> &frame,
+                                           const std::vector<uint32_t> &keys,
+                                           DiehlLfsrCheckMethod check_method,
+                                           uint32_t check_value);
+
+// Diehl: counters of LFSR key trials, to spot meters that pay for many keys
+struct DiehlKeyTrialStats {
+  uint32_t attempts = 0;          // decodeDiehlLfsr calls
+  uint32_t remembered_hits = 0;   // remembered key decoded the telegram
+  uint32_t remembered_misses = 0; // remembered key failed and was demoted
+};
+
+const DiehlKeyTrialStats &diehlKeyTrialStats();
+
 // Diehl: frame interpretation
 enum class DiehlFrameInterpretation {
   NA, // N/A: not a Diehl frame
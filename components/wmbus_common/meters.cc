@@ -28,9 +28,16 @@
 #include <numeric>
 #include <stdexcept>
 #include <time.h>
+#include <tuple>
+#include <unordered_map>
 
 std::map<std::string, DriverInfo> *registered_drivers_ = NULL;
 std::vector<DriverInfo *> *registered_drivers_list_ = NULL;
+// Driver names and aliases -> driver, for constant time lookupDriver.
+std::unordered_map<std::string, DriverInfo *> *driver_names_index_ = NULL;
+// Detection (mfct,type,version) -> drivers, in registration order.
+std::unordered_map<uint32_t, std::vector<DriverInfo *>>
+    *driver_detect_index_ = NULL;
 
 void verifyDriverLookupCreated() {
   if (registered_drivers_ == NULL) {
@@ -39,23 +46,37 @@ void verifyDriverLookupCreated() {
   if (registered_drivers_list_ == NULL) {
     registered_drivers_list_ = new std::vector<DriverInfo *>;
   }
+  if (driver_names_index_ == NULL) {
+    driver_names_index_ = new std::unordered_map<std::string, DriverInfo *>;
+  }
+  if (driver_detect_index_ == NULL) {
+    driver_detect_index_ =
+        new std::unordered_map<uint32_t, std::vector<DriverInfo *>>;
+  }
 }
 
-DriverInfo *lookupDriver(std::string name) {
+// Some weird meters (aptor08 and itronheat) send a mfct where the first
+// character is lower case, therefore the key restricts mfct to 15 bits.
+static uint32_t driverDetectKey(int mfct, int type, int version) {
+  return (uint32_t)(mfct & 0x7fff) << 16 | (uint32_t)(type & 0xff) << 8 |
+         (uint32_t)(version & 0xff);
+}
+
+static const std::vector<DriverInfo *> &detectedDrivers(int mfct, int type,
+                                                        int version) {
+  static const std::vector<DriverInfo *> none;
   verifyDriverLookupCreated();
+  auto i = driver_detect_index_->find(driverDetectKey(mfct, type, version));
+  return i != driver_detect_index_->end() ? i->second : none;
+}
 
-  // Check if we have a compiled/loaded driver available.
-  if (registered_drivers_->count(name) == 1) {
-    return &(*registered_drivers_)[name];
-  }
+DriverInfo *lookupDriver(std::string name) {
+  verifyDriverLookupCreated();
 
-  // No, ok lets look for driver aliases.
-  for (DriverInfo *di : *registered_drivers_list_) {
-    for (DriverName &dn : di->nameAliases()) {
-      if (dn.str() == name) {
-        return di;
-      }
-    }
+  // Check if we have a compiled/loaded driver available, by name or alias.
+  auto i = driver_names_index_->find(name);
+  if (i != driver_names_index_->end()) {
+    return i->second;
   }
 
   return NULL;
@@ -72,6 +93,21 @@ void removeDriver(const std::string &name) {
     }
   }
 
+  if (registered_drivers_->count(name) == 1) {
+    DriverInfo *di = &(*registered_drivers_)[name];
+    for (auto i = driver_names_index_->begin();
+         i != driver_names_index_->end();) {
+      if (i->second == di)
+        i = driver_names_index_->erase(i);
+      else
+        i++;
+    }
+    for (auto &d : *driver_detect_index_) {
+      d.second.erase(std::remove(d.second.begin(), d.second.end(), di),
+                     d.second.end());
+    }
+  }
+
   registered_drivers_->erase(name);
   assert(registered_drivers_->count(name) == 0);
 }
@@ -85,8 +121,24 @@ void addRegisteredDriver(DriverInfo di) {
   }
 
   (*registered_drivers_)[di.name().str()] = di;
-  // The list elements points into the map.
-  (*registered_drivers_list_).push_back(lookupDriver(di.name().str()));
+  // The list and index elements point into the map.
+  DriverInfo *p = &(*registered_drivers_)[di.name().str()];
+  (*registered_drivers_list_).push_back(p);
+
+  (*driver_names_index_)[p->name().str()] = p;
+  for (DriverName &dn : p->nameAliases()) {
+    // A real driver name takes precedence over an alias.
+    driver_names_index_->emplace(dn.str(), p);
+  }
+
+  for (auto &dd : p->detect()) {
+    if (dd.mfct == 0 && dd.type == 0 && dd.version == 0)
+      continue; // Ignore drivers with no detection.
+    auto &drivers =
+        (*driver_detect_index_)[driverDetectKey(dd.mfct, dd.type, dd.version)];
+    if (std::find(drivers.begin(), drivers.end(), p) == drivers.end())
+      drivers.push_back(p);
+  }
 }
 
 bool DriverInfo::detect(uint16_t mfct, uchar type, uchar version) {
@@ -131,13 +183,12 @@ bool forceRegisterDriver(std::function<void(DriverInfo &)> setup) {
 
   // Check that no other driver also triggers on the same detection values.
   for (auto &d : di.detect()) {
-    for (DriverInfo *p : allDrivers()) {
-      bool foo = p->detect(d.mfct, d.type, d.version);
-      if (foo) {
-        error("Internal error: driver %s tried to register the same auto "
-              "detect combo as driver %s alread has taken!\n",
-              di.name().str().c_str(), p->name().str().c_str());
-      }
+    if (d.mfct == 0 && d.type == 0 && d.version == 0)
+      continue;
+    for (DriverInfo *p : detectedDrivers(d.mfct, d.type, d.version)) {
+      error("Internal error: driver %s tried to register the same auto "
+            "detect combo as driver %s alread has taken!\n",
+            di.name().str().c_str(), p->name().str().c_str());
     }
   }
 
@@ -160,13 +211,12 @@ bool registerDriver(std::function<void(DriverInfo &)> setup) {
 
   // Check that no other driver also triggers on the same detection values.
   for (auto &d : di.detect()) {
-    for (DriverInfo *p : allDrivers()) {
-      bool foo = p->detect(d.mfct, d.type, d.version);
-      if (foo) {
-        error("Internal error: driver %s tried to register the same auto "
-              "detect combo as driver %s alread has taken!\n",
-              di.name().str().c_str(), p->name().str().c_str());
-      }
+    if (d.mfct == 0 && d.type == 0 && d.version == 0)
+      continue;
+    for (DriverInfo *p : detectedDrivers(d.mfct, d.type, d.version)) {
+      error("Internal error: driver %s tried to register the same auto "
+            "detect combo as driver %s alread has taken!\n",
+            di.name().str().c_str(), p->name().str().c_str());
     }
   }
 
@@ -219,6 +269,27 @@ MeterCommonImplementation::MeterCommonImplementation(MeterInfo &mi,
 
   link_modes_.unionLinkModeSet(di.linkModes());
   force_mfct_index_ = di.forceMfctIndex();
+
+  // All meters of a driver share one table of field infos. The first meter
+  // constructed builds it, for the others the add*Field calls are no-ops.
+  field_infos_ = di.fieldInfos();
+  shares_driver_fields_ = field_infos_ != NULL;
+  if (!shares_driver_fields_) {
+    field_infos_ = std::make_shared<std::vector<FieldInfo>>();
+    di.setFieldInfos(field_infos_);
+  }
+}
+
+void MeterCommonImplementation::useOwnFieldInfos() {
+  if (driver_info_ != NULL && field_infos_ == driver_info_->fieldInfos())
+    field_infos_ = std::make_shared<std::vector<FieldInfo>>(*field_infos_);
+
+  if (shares_driver_fields_) {
+    shares_driver_fields_ = false;
+    num_driver_fields_ = std::count_if(
+        field_infos_->begin(), field_infos_->end(),
+        [](FieldInfo &fi) { return fi.index() != -1; });
+  }
 }
 
 void MeterCommonImplementation::addShellMeterAdded(std::string cmdline) {
@@ -255,6 +326,9 @@ void MeterCommonImplementation::addExtraCalculatedField(std::string ecf) {
 
   Quantity quantity = toQuantity(unit);
 
+  // Calculated fields are meter specific, do not add them to the shared table.
+  useOwnFieldInfos();
+
   FieldInfo *existing = findFieldInfo(vname, quantity);
   if (existing != NULL) {
     if (!canConvert(unit, existing->displayUnit())) {
@@ -297,10 +371,13 @@ void MeterCommonImplementation::addLinkMode(LinkMode lm) {
 void MeterCommonImplementation::setMfctTPLStatusBits(
     Translate::Lookup &lookup) {
   mfct_tpl_status_bits_ = lookup;
+  tpl_sts_decoded_ = -1;
 }
 
 void MeterCommonImplementation::markLastFieldAsLibrary() {
-  field_infos_.back().markAsLibrary();
+  if (shares_driver_fields_)
+    return;
+  field_infos_->back().markAsLibrary();
   num_driver_fields_--;
 }
 
@@ -308,8 +385,10 @@ void MeterCommonImplementation::addNumericFieldWithExtractor(
     std::string vname, std::string help, PrintProperties print_properties,
     Quantity vquantity, VifScaling vif_scaling, DifSignedness dif_signedness,
     FieldMatcher matcher, Unit display_unit, double scale) {
+  if (shares_driver_fields_)
+    return;
   size_t index = num_driver_fields_++;
-  field_infos_.emplace_back(FieldInfo(
+  field_infos_->emplace_back(FieldInfo(
       index, vname, vquantity,
       display_unit == Unit::Unknown ? defaultUnitForQuantity(vquantity)
                                     : display_unit,
@@ -323,6 +402,8 @@ void MeterCommonImplementation::addNumericFieldWithExtractor(
 void MeterCommonImplementation::addNumericFieldWithCalculator(
     std::string vname, std::string help, PrintProperties print_properties,
     Quantity vquantity, std::string formula, Unit display_unit) {
+  if (shares_driver_fields_)
+    return;
   Formula *f = newFormula();
   bool ok = f->parse(this, formula);
   if (!ok) {
@@ -335,7 +416,7 @@ void MeterCommonImplementation::addNumericFieldWithCalculator(
   assert(ok);
 
   size_t index = num_driver_fields_++;
-  field_infos_.push_back(FieldInfo(
+  field_infos_->push_back(FieldInfo(
       index, vname, vquantity,
       display_unit == Unit::Unknown ? defaultUnitForQuantity(vquantity)
                                     : display_unit,
@@ -351,6 +432,8 @@ void MeterCommonImplementation::addNumericFieldWithCalculatorAndMatcher(
     std::string vname, std::string help, PrintProperties print_properties,
     Quantity vquantity, std::string formula, FieldMatcher matcher,
     Unit display_unit) {
+  if (shares_driver_fields_)
+    return;
   Formula *f = newFormula();
   bool ok = f->parse(this, formula);
   if (!ok) {
@@ -363,7 +446,7 @@ void MeterCommonImplementation::addNumericFieldWithCalculatorAndMatcher(
   assert(ok);
 
   size_t index = num_driver_fields_++;
-  field_infos_.push_back(FieldInfo(
+  field_infos_->push_back(FieldInfo(
       index, vname, vquantity,
       display_unit == Unit::Unknown ? defaultUnitForQuantity(vquantity)
                                     : display_unit,
@@ -377,8 +460,10 @@ void MeterCommonImplementation::addNumericFieldWithCalculatorAndMatcher(
 void MeterCommonImplementation::addNumericField(
     std::string vname, Quantity vquantity, PrintProperties print_properties,
     std::string help, Unit display_unit) {
+  if (shares_driver_fields_)
+    return;
   size_t index = num_driver_fields_++;
-  field_infos_.emplace_back(FieldInfo(
+  field_infos_->emplace_back(FieldInfo(
       index, vname, vquantity,
       display_unit == Unit::Unknown ? defaultUnitForQuantity(vquantity)
                                     : display_unit,
@@ -396,8 +481,10 @@ void MeterCommonImplementation::addNumericField(
 void MeterCommonImplementation::addStringFieldWithExtractor(
     std::string vname, std::string help, PrintProperties print_properties,
     FieldMatcher matcher) {
+  if (shares_driver_fields_)
+    return;
   size_t index = num_driver_fields_++;
-  field_infos_.emplace_back(FieldInfo(
+  field_infos_->emplace_back(FieldInfo(
       index, vname, Quantity::Text, defaultUnitForQuantity(Quantity::Text),
       VifScaling::None, DifSignedness::Signed, 1.0, matcher, help,
       print_properties, NULL, NULL, NULL, NULL, NoLookup, /* Lookup table */
@@ -409,8 +496,10 @@ void MeterCommonImplementation::addStringFieldWithExtractor(
 void MeterCommonImplementation::addStringFieldWithExtractorAndLookup(
     std::string vname, std::string help, PrintProperties print_properties,
     FieldMatcher matcher, Translate::Lookup lookup) {
+  if (shares_driver_fields_)
+    return;
   size_t index = num_driver_fields_++;
-  field_infos_.emplace_back(FieldInfo(
+  field_infos_->emplace_back(FieldInfo(
       index, vname, Quantity::Text, defaultUnitForQuantity(Quantity::Text),
       VifScaling::None, DifSignedness::Signed, 1.0, matcher, help,
       print_properties, NULL, NULL, NULL, NULL, lookup, NULL, /* Formula */
@@ -420,8 +509,10 @@ void MeterCommonImplementation::addStringFieldWithExtractorAndLookup(
 
 void MeterCommonImplementation::addStringField(
     std::string vname, std::string help, PrintProperties print_properties) {
+  if (shares_driver_fields_)
+    return;
   size_t index = num_driver_fields_++;
-  field_infos_.emplace_back(FieldInfo(
+  field_infos_->emplace_back(FieldInfo(
       index, vname, Quantity::Text, defaultUnitForQuantity(Quantity::Text),
       VifScaling::None, DifSignedness::Signed, 1.0, FieldMatcher(), help,
       print_properties, NULL, NULL, NULL, NULL, NoLookup, /* Lookup table */
@@ -440,7 +531,7 @@ IdentityMode MeterCommonImplementation::identityMode() {
 }
 
 std::vector<FieldInfo> &MeterCommonImplementation::fieldInfos() {
-  return field_infos_;
+  return *field_infos_;
 }
 
 std::vector<std::string> &MeterCommonImplementation::extraConstantFields() {
@@ -532,30 +623,29 @@ std::string toString(DriverInfo &di) { return di.name().str(); }
 bool MeterCommonImplementation::isTelegramForMeter(Telegram *t, Meter *meter,
                                                    MeterInfo *mi) {
   std::string name;
-  std::vector<AddressExpression> address_expressions;
+  std::vector<AddressExpression> *address_expressions;
   std::string driver_name;
 
   assert((meter && !mi) || (!meter && mi));
 
   if (meter) {
     name = meter->name();
-    address_expressions = meter->addressExpressions();
+    address_expressions = &meter->addressExpressions();
     driver_name = meter->driverName().str();
   } else {
     name = mi->name;
-    address_expressions = mi->address_expressions;
+    address_expressions = &mi->address_expressions;
     driver_name = mi->driver_name.str();
   }
 
-  // Telegram addresses
-  std::string t_idsc = Address::concat(t->addresses);
-  // Meter/MeterInfo address expressions
-  std::string m_idsc = AddressExpression::concat(address_expressions);
-  debug("(meter) %s: for me? %s in %s\n", name.c_str(), t_idsc.c_str(),
-        m_idsc.c_str());
+  // The concatenated telegram addresses and meter address expressions are
+  // only built when verbose logging is compiled in.
+  debug("(meter) %s: for me? %s in %s\n", name.c_str(),
+        Address::concat(t->addresses).c_str(),
+        AddressExpression::concat(*address_expressions).c_str());
 
   bool used_wildcard = false;
-  bool match = doesTelegramMatchExpressions(t->addresses, address_expressions,
+  bool match = doesTelegramMatchExpressions(t->addresses, *address_expressions,
                                             &used_wildcard);
 
   if (!match) {
@@ -757,8 +847,16 @@ std::string concatFields(Meter *m, Telegram *t, char c,
 
 bool MeterCommonImplementation::handleTelegram(
     AboutTelegram &about, std::vector<uchar> input_frame, bool simulated,
-    std::vector<Address> *addresses, bool *id_match, Telegram *out_analyzed) {
-  Telegram t;
+    std::vector<Address> *addresses, bool *id_match, Telegram *out_analyzed,
+    TelegramStage *stage) {
+  // Parse straight into the caller's telegram, if any, instead of copying the
+  // whole telegram into it afterwards.
+  TelegramStage local_stage;
+  if (stage == NULL)
+    stage = &local_stage;
+  *stage = TelegramStage::HEADER;
+  Telegram local;
+  Telegram &t = out_analyzed != NULL ? *out_analyzed : local;
   t.about = about;
   bool ok = t.parseHeader(input_frame);
 
@@ -775,6 +873,7 @@ bool MeterCommonImplementation::handleTelegram(
   }
 
   *id_match = true;
+  *stage = TelegramStage::PARSE;
 
   verbose("(meter) %s(%d) %s  handling telegram from %s\n", name().c_str(),
           index(), driverName().str().c_str(),
@@ -792,8 +891,6 @@ bool MeterCommonImplementation::handleTelegram(
 
   ok = t.parse(input_frame, &meter_keys_, true);
   if (!ok) {
-    if (out_analyzed != NULL)
-      *out_analyzed = t;
     // Ignoring telegram since it could not be parsed.
     return false;
   }
@@ -802,8 +899,14 @@ bool MeterCommonImplementation::handleTelegram(
   // snprintf(log_prefix, 255, "(%s) log", driverName().str().c_str());
   // logTelegram(t.original, t.frame, t.header_size, t.suffix_size);
 
+  telegram_seq_++;
+
   // Invoke standardized field extractors!
-  processFieldExtractors(&t);
+  size_t extracted = processFieldExtractors(&t);
+  // A driver with its own content parsing may need no dv entries at all.
+  *stage = extracted == 0 && !t.dv_entries.empty() && !hasProcessContent()
+               ? TelegramStage::CONTENT
+               : TelegramStage::HANDLED;
   if (hasProcessContent()) {
     // Invoke tailor made meter specific parsing!
     processContent(&t);
@@ -818,12 +921,10 @@ bool MeterCommonImplementation::handleTelegram(
 
   triggerUpdate(&t);
 
-  if (out_analyzed != NULL)
-    *out_analyzed = t;
   return true;
 }
 
-void MeterCommonImplementation::processFieldExtractors(Telegram *t) {
+size_t MeterCommonImplementation::processFieldExtractors(Telegram *t) {
   // Multiple dventries can be matched against a single wildcard FieldInfo.
   std::map<FieldInfo *, std::set<DVEntry *>> founds;
 
@@ -840,7 +941,7 @@ void MeterCommonImplementation::processFieldExtractors(Telegram *t) {
        });
 
   // Now go through each field_info defined by the driver.
-  for (FieldInfo &fi : field_infos_) {
+  for (FieldInfo &fi : *field_infos_) {
     int current_match_nr = 0;
 
     if (!fi.hasMatcher()) {
@@ -892,7 +993,7 @@ void MeterCommonImplementation::processFieldExtractors(Telegram *t) {
 
   // Iterate over the fields that has no matcher rule. Ie the field
   // itself does the searching and matching.
-  for (FieldInfo &fi : field_infos_) {
+  for (FieldInfo &fi : *field_infos_) {
     if (!fi.hasMatcher()) {
       fi.performExtraction(this, t, NULL);
     } else if (founds.count(&fi) == 0 &&
@@ -903,11 +1004,12 @@ void MeterCommonImplementation::processFieldExtractors(Telegram *t) {
       fi.performExtraction(this, t, NULL);
     }
   }
+  return founds.size();
 }
 
 void MeterCommonImplementation::processFieldCalculators() {
   // Iterate over the fields with formulas but no matcher.
-  for (FieldInfo &fi : field_infos_) {
+  for (FieldInfo &fi : *field_infos_) {
     if (fi.hasFormula() && !fi.hasMatcher()) {
       debug("(meters) calculating field %s(%s)[%d]\n", fi.vname().c_str(),
             toString(fi.xuantity()), fi.index());
@@ -917,26 +1019,26 @@ void MeterCommonImplementation::processFieldCalculators() {
 }
 
 std::string MeterCommonImplementation::getStatusField(FieldInfo *fi) {
-  std::string field_name_no_unit = fi->vname();
-  if (string_values_.count(field_name_no_unit) == 0) {
+  StringField &sf = stringSlot(fi).value;
+  if (sf.field_info == NULL) {
     return "null"; // This is translated to a real(non-std::string) null in the
                    // json.
   }
-  StringField &sf = string_values_[field_name_no_unit];
+  // The status is usually the same from telegram to telegram, only join
+  // and sort the flags again if any string value has changed.
+  if (status_rendered_fi_ == fi && status_rendered_at_ == string_changes_)
+    return status_rendered_;
+
   std::string value = sf.value;
 
   // This is >THE< status field, only one is allowed.
   // Look for other fields with the JOIN_INTO_STATUS marker.
   // These other fields will not be printed, instead
   // joined into this status field.
-  for (FieldInfo &f : field_infos_) {
+  for (FieldInfo &f : *field_infos_) {
     if (f.printProperties().hasINJECTINTOSTATUS()) {
-      // printf("NOW >%s<\n", value.c_str());
       std::string more = getStringValue(&f);
-      // printf("MORE >%s<\n", more.c_str());
-      std::string joined = joinStatusOKStrings(value, more);
-      // printf("JOINED >%s<\n", joined.c_str());
-      value = joined;
+      value = joinStatusOKStrings(value, more);
     }
   }
   // Sort all found flags and remove any duplicates. A well designed meter
@@ -945,6 +1047,10 @@ std::string MeterCommonImplementation::getStatusField(FieldInfo *fi) {
   // If it is empty, then translate to OK!
   if (value == "")
     value = "OK";
+
+  status_rendered_fi_ = fi;
+  status_rendered_at_ = string_changes_;
+  status_rendered_ = value;
   return value;
 }
 
@@ -954,18 +1060,82 @@ bool MeterCommonImplementation::hasProcessContent() {
   return has_process_content_;
 }
 
+void MeterCommonImplementation::assignValueSlots(FieldInfo *fi) {
+  if (fi->numericSlot() >= 0)
+    return;
+
+  std::vector<FieldInfo> &fis = *field_infos_;
+  assert(fi >= fis.data() && fi < fis.data() + fis.size());
+  int pos = fi - fis.data();
+  int numeric_slot = pos;
+  int string_slot = pos;
+
+  // Share the slot with the first field info using the same vname.
+  for (int i = 0; i < pos; i++) {
+    if (fis[i].vname() != fi->vname())
+      continue;
+    if (string_slot == pos)
+      string_slot = i;
+    if (numeric_slot == pos && fis[i].displayUnit() == fi->displayUnit())
+      numeric_slot = i;
+  }
+  fi->setValueSlots(numeric_slot, string_slot);
+}
+
+ValueSlot<NumericField> &MeterCommonImplementation::numericSlot(FieldInfo *fi) {
+  assignValueSlots(fi);
+  size_t slot = fi->numericSlot();
+  if (numeric_values_.size() <= slot)
+    numeric_values_.resize(field_infos_->size());
+  return numeric_values_[slot];
+}
+
+ValueSlot<StringField> &MeterCommonImplementation::stringSlot(FieldInfo *fi) {
+  assignValueSlots(fi);
+  size_t slot = fi->stringSlot();
+  if (string_values_.size() <= slot)
+    string_values_.resize(field_infos_->size());
+  return string_values_[slot];
+}
+
+// Find the field info whose slot stores the value named field_name_no_unit
+// generated by fi. Returns NULL if the name is only an expansion of fi.
+FieldInfo *MeterCommonImplementation::findValueField(
+    FieldInfo *fi, std::string_view field_name_no_unit) {
+  if (field_name_no_unit == fi->vname())
+    return fi;
+
+  for (FieldInfo &f : *field_infos_) {
+    if (f.vname() == field_name_no_unit &&
+        (fi->xuantity() == Quantity::Text ||
+         f.displayUnit() == fi->displayUnit()))
+      return &f;
+  }
+  return NULL;
+}
+
 void MeterCommonImplementation::setNumericValue(FieldInfo *fi, DVEntry *dve,
                                                 Unit u, double v) {
-  std::string field_name_no_unit;
-
   if (dve == NULL) {
-    std::string field_name_no_unit = fi->vname();
-    numeric_values_[std::pair<std::string, Unit>(
-        field_name_no_unit, fi->displayUnit())] = NumericField(u, v, fi);
+    ValueSlot<NumericField>::store(&numericSlot(fi).value,
+                                   NumericField(u, v, fi), telegram_seq_);
+    return;
+  }
+
+  std::string_view field_name_no_unit = fi->fieldNameNoUnit(this, dve);
+  NumericField *nf = numericSlot(fi).findExpanded(field_name_no_unit);
+  if (nf != NULL) {
+    ValueSlot<NumericField>::store(nf, NumericField(u, v, fi, *dve),
+                                   telegram_seq_);
+    return;
+  }
+  FieldInfo *vf = findValueField(fi, field_name_no_unit);
+  if (vf != NULL) {
+    ValueSlot<NumericField>::store(&numericSlot(vf).value,
+                                   NumericField(u, v, fi, *dve), telegram_seq_);
   } else {
-    field_name_no_unit = fi->generateFieldNameNoUnit(this, dve);
-    numeric_values_[std::pair<std::string, Unit>(
-        field_name_no_unit, fi->displayUnit())] = NumericField(u, v, fi, *dve);
+    numericSlot(fi).setExpanded(field_name_no_unit,
+                                NumericField(u, v, fi, *dve), telegram_seq_);
   }
 }
 
@@ -988,47 +1158,76 @@ bool MeterCommonImplementation::hasValue(FieldInfo *fi) {
 }
 
 bool MeterCommonImplementation::hasNumericValue(FieldInfo *fi) {
-  std::pair<std::string, Unit> key(fi->vname(), fi->displayUnit());
-
-  return numeric_values_.count(key) != 0;
+  return numericSlot(fi).value.field_info != NULL;
 }
 
 bool MeterCommonImplementation::hasStringValue(FieldInfo *fi) {
-  return string_values_.count(fi->vname()) != 0;
+  return stringSlot(fi).value.field_info != NULL;
 }
 
 double MeterCommonImplementation::getNumericValue(FieldInfo *fi, Unit to) {
-  std::string field_name_no_unit = fi->vname();
-  std::pair<std::string, Unit> key(field_name_no_unit, fi->displayUnit());
-  if (numeric_values_.count(key) == 0) {
+  NumericField &nf = numericSlot(fi).value;
+  if (nf.field_info == NULL) {
     return std::numeric_limits<double>::quiet_NaN(); // This is translated into
                                                      // a null in the json.
   }
-  NumericField &nf = numeric_values_[key];
   return convert(nf.value, nf.unit, to);
 }
 
-double MeterCommonImplementation::getNumericValue(std::string vname, Unit to) {
-  std::pair<std::string, Unit> key(vname, to);
-  if (numeric_values_.count(key) == 0) {
+double MeterCommonImplementation::getNumericValue(
+    FieldInfo *fi, std::string_view field_name_no_unit, Unit to) {
+  NumericField *nf = numericSlot(fi).findExpanded(field_name_no_unit);
+  if (nf == NULL) {
+    FieldInfo *vf = findValueField(fi, field_name_no_unit);
+    if (vf != NULL)
+      nf = &numericSlot(vf).value;
+  }
+  if (nf == NULL || nf->field_info == NULL || to != fi->displayUnit()) {
     return std::numeric_limits<double>::quiet_NaN(); // This is translated into
                                                      // a null in the json.
   }
-  NumericField &nf = numeric_values_[key];
-  return convert(nf.value, nf.unit, to);
+  return convert(nf->value, nf->unit, to);
+}
+
+double MeterCommonImplementation::getNumericValue(std::string vname, Unit to) {
+  // Values are only found by name in their display unit.
+  for (size_t i = 0; i < numeric_values_.size(); i++) {
+    ValueSlot<NumericField> &slot = numeric_values_[i];
+    NumericField *nf = NULL;
+    if (slot.value.field_info != NULL && (*field_infos_)[i].vname() == vname)
+      nf = &slot.value;
+    else
+      nf = slot.findExpanded(vname);
+    if (nf != NULL && nf->field_info->displayUnit() == to)
+      return convert(nf->value, nf->unit, to);
+  }
+  return std::numeric_limits<double>::quiet_NaN(); // This is translated into
+                                                   // a null in the json.
 }
 
 void MeterCommonImplementation::setStringValue(FieldInfo *fi, std::string v,
                                                DVEntry *dve) {
-  std::string field_name_no_unit;
-
+  bool changed;
   if (dve == NULL) {
-    std::string field_name_no_unit = fi->vname();
-    string_values_[field_name_no_unit] = StringField(v, fi);
+    changed = ValueSlot<StringField>::store(&stringSlot(fi).value,
+                                            StringField(v, fi), telegram_seq_);
   } else {
-    field_name_no_unit = fi->generateFieldNameNoUnit(this, dve);
-    string_values_[field_name_no_unit] = StringField(v, fi);
+    std::string_view field_name_no_unit = fi->fieldNameNoUnit(this, dve);
+    StringField *sf = stringSlot(fi).findExpanded(field_name_no_unit);
+    FieldInfo *vf = NULL;
+    if (sf != NULL) {
+      changed =
+          ValueSlot<StringField>::store(sf, StringField(v, fi), telegram_seq_);
+    } else if ((vf = findValueField(fi, field_name_no_unit)) != NULL) {
+      changed = ValueSlot<StringField>::store(&stringSlot(vf).value,
+                                              StringField(v, fi), telegram_seq_);
+    } else {
+      changed = stringSlot(fi).setExpanded(field_name_no_unit,
+                                           StringField(v, fi), telegram_seq_);
+    }
   }
+  if (changed)
+    string_changes_++;
 }
 
 void MeterCommonImplementation::setStringValue(std::string vname, std::string v,
@@ -1045,45 +1244,29 @@ void MeterCommonImplementation::setStringValue(std::string vname, std::string v,
 }
 
 std::string MeterCommonImplementation::getStringValue(FieldInfo *fi) {
-  std::string field_name_no_unit = fi->vname();
-  if (string_values_.count(field_name_no_unit) == 0) {
+  if (fi->printProperties().hasSTATUS())
+    return getStatusField(fi);
+
+  StringField &sf = stringSlot(fi).value;
+  if (sf.field_info == NULL) {
     return "null"; // This is translated to a real(non-std::string) null in the
                    // json.
   }
-  StringField &sf = string_values_[field_name_no_unit];
-  std::string value = sf.value;
-
-  if (fi->printProperties().hasSTATUS()) {
-    // This is >THE< status field, only one is allowed.
-    // Look for other fields with the JOIN_INTO_STATUS marker.
-    // These other fields will not be printed, instead
-    // joined into this status field.
-    for (FieldInfo &f : field_infos_) {
-      if (f.printProperties().hasINJECTINTOSTATUS()) {
-        std::string more = getStringValue(&f);
-        std::string joined = joinStatusOKStrings(value, more);
-        value = joined;
-      }
-    }
-    // Sort all found flags and remove any duplicates. A well designed meter
-    // decoder should not be able to generate duplicates.
-    value = sortStatusString(value);
-    // If it is empty, then translate to OK!
-    if (value == "")
-      value = "OK";
-  }
-
-  return value;
+  return sf.value;
 }
 
 std::string MeterCommonImplementation::decodeTPLStatusByte(uchar sts) {
-  return ::decodeTPLStatusByteWithMfct(sts, mfct_tpl_status_bits_);
+  if (tpl_sts_decoded_ != sts) {
+    tpl_status_ = ::decodeTPLStatusByteWithMfct(sts, mfct_tpl_status_bits_);
+    tpl_sts_decoded_ = sts;
+  }
+  return tpl_status_;
 }
 
 FieldInfo *MeterCommonImplementation::findFieldInfo(std::string vname,
                                                     Quantity xuantity) {
   FieldInfo *found = NULL;
-  for (FieldInfo &p : field_infos_) {
+  for (FieldInfo &p : *field_infos_) {
     if (p.vname() == vname && p.xuantity() == xuantity) {
       found = &p;
       break;
@@ -1103,27 +1286,259 @@ MeterCommonImplementation::renderJsonOnlyDefaultUnit(std::string vname,
   return fi->renderJsonOnlyDefaultUnit(this);
 }
 
+std::vector<std::pair<const std::string *, NumericField *>>
+MeterCommonImplementation::sortedNumericValues() {
+  std::vector<std::pair<const std::string *, NumericField *>> values;
+
+  for (size_t i = 0; i < numeric_values_.size(); i++) {
+    ValueSlot<NumericField> &slot = numeric_values_[i];
+    if (slot.value.field_info != NULL)
+      values.emplace_back(&(*field_infos_)[i].vname(), &slot.value);
+    for (auto &p : slot.expanded)
+      values.emplace_back(&p.first, &p.second);
+  }
+  std::sort(values.begin(), values.end(), [](auto &a, auto &b) {
+    int c = a.first->compare(*b.first);
+    if (c != 0)
+      return c < 0;
+    return a.second->field_info->displayUnit() <
+           b.second->field_info->displayUnit();
+  });
+
+  return values;
+}
+
+std::vector<std::pair<const std::string *, StringField *>>
+MeterCommonImplementation::sortedStringValues() {
+  std::vector<std::pair<const std::string *, StringField *>> values;
+
+  for (size_t i = 0; i < string_values_.size(); i++) {
+    ValueSlot<StringField> &slot = string_values_[i];
+    if (slot.value.field_info != NULL)
+      values.emplace_back(&(*field_infos_)[i].vname(), &slot.value);
+    for (auto &p : slot.expanded)
+      values.emplace_back(&p.first, &p.second);
+  }
+  std::sort(values.begin(), values.end(),
+            [](auto &a, auto &b) { return *a.first < *b.first; });
+
+  return values;
+}
+
 std::string MeterCommonImplementation::debugValues() {
   std::string s;
 
-  for (auto &p : numeric_values_) {
-    std::string vname = p.first.first;
-    std::string us = unitToStringLowerCase(p.first.second);
-    NumericField &nf = p.second;
+  for (auto &p : sortedNumericValues()) {
+    NumericField &nf = *p.second;
+    std::string us = unitToStringLowerCase(nf.field_info->displayUnit());
 
-    s += tostrprintf("%s_%s = %g\n", vname.c_str(), us.c_str(), nf.value);
+    s += tostrprintf("%s_%s = %g\n", p.first->c_str(), us.c_str(), nf.value);
   }
 
-  for (auto &p : string_values_) {
-    std::string vname = p.first;
-    StringField &nf = p.second;
+  for (auto &p : sortedStringValues()) {
+    StringField &nf = *p.second;
 
-    s += tostrprintf("%s = \"%s\"\n", vname.c_str(), nf.value.c_str());
+    s += tostrprintf("%s = \"%s\"\n", p.first->c_str(), nf.value.c_str());
   }
 
   return s;
 }
 
+// The snapshot starts with a version byte, a hash of the names and display
+// units of the field infos (u32) and the time of the last update (u32). Then
+// a record per value:
+//   flags (u8): 1 = string value, 2 = expanded name follows,
+//               4 = slot index follows
+//   index of the value's field info (u16)
+//   [index of the slot (u16), when the value is stored in the slot of
+//    another field info with the same name]
+//   [length of the expanded name (u8), name]
+//   numeric: unit (u8), value (double)
+//   string: length (u8), value
+// Integers are little endian, the double is in host order.
+static const uchar SNAPSHOT_VERSION = 2;
+static const uchar SNAPSHOT_STRING = 1;
+static const uchar SNAPSHOT_EXPANDED = 2;
+static const uchar SNAPSHOT_SLOT = 4;
+
+static void snapshotRecord(std::vector<uchar> *out, uchar flags, size_t index,
+                           size_t slot, const std::string *name) {
+  if (name != NULL)
+    flags |= SNAPSHOT_EXPANDED;
+  else if (slot != index)
+    flags |= SNAPSHOT_SLOT;
+  out->push_back(flags);
+  out->push_back(index & 0xff);
+  out->push_back(index >> 8);
+  if (flags & SNAPSHOT_SLOT) {
+    out->push_back(slot & 0xff);
+    out->push_back(slot >> 8);
+  }
+  if (name != NULL) {
+    size_t n = std::min<size_t>(name->size(), 255);
+    out->push_back(n);
+    out->insert(out->end(), name->begin(), name->begin() + n);
+  }
+}
+
+static void snapshotNumeric(std::vector<uchar> *out, size_t index, size_t slot,
+                            const std::string *name, NumericField &nf) {
+  snapshotRecord(out, 0, index, slot, name);
+  out->push_back((uchar)nf.unit);
+  uchar v[sizeof(double)];
+  memcpy(v, &nf.value, sizeof(v));
+  out->insert(out->end(), v, v + sizeof(v));
+}
+
+static void snapshotString(std::vector<uchar> *out, size_t index, size_t slot,
+                           const std::string *name, StringField &sf) {
+  snapshotRecord(out, SNAPSHOT_STRING, index, slot, name);
+  size_t n = std::min<size_t>(sf.value.size(), 255);
+  out->push_back(n);
+  out->insert(out->end(), sf.value.begin(), sf.value.begin() + n);
+}
+
+// The values are stored by the index of their field info. The hash tells a
+// snapshot taken with other field infos, eg by an older version of the
+// driver, even when there are as many of them.
+static uint32_t snapshotLayout(std::vector<FieldInfo> &fis) {
+  // 32 bit FNV-1a.
+  uint32_t hash = 0x811c9dc5;
+  auto add = [&](uchar c) {
+    hash ^= c;
+    hash *= 0x01000193;
+  };
+  for (FieldInfo &fi : fis) {
+    for (char c : fi.vname())
+      add(c);
+    add(0);
+    add((uchar)fi.displayUnit());
+  }
+  return hash;
+}
+
+static void snapshotU32(std::vector<uchar> *out, uint32_t v) {
+  for (int i = 0; i < 4; i++)
+    out->push_back(v >> (8 * i));
+}
+
+static uint32_t restoreU32(const uchar *data) {
+  return data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+void MeterCommonImplementation::snapshotValues(std::vector<uchar> *out,
+                                               size_t max_len) {
+  std::vector<FieldInfo> &fis = *field_infos_;
+  size_t start = out->size();
+  out->push_back(SNAPSHOT_VERSION);
+  snapshotU32(out, snapshotLayout(fis));
+  snapshotU32(out, datetime_of_update_);
+
+  // Drop the last record again if it made the snapshot too long.
+  size_t end = out->size();
+  auto fits = [&]() {
+    if (out->size() - start > max_len)
+      out->resize(end);
+    end = out->size();
+  };
+
+  for (size_t i = 0; i < numeric_values_.size(); i++) {
+    NumericField &nf = numeric_values_[i].value;
+    if (nf.field_info != NULL) {
+      snapshotNumeric(out, nf.field_info - fis.data(), i, NULL, nf);
+      fits();
+    }
+  }
+  for (size_t i = 0; i < string_values_.size(); i++) {
+    StringField &sf = string_values_[i].value;
+    if (sf.field_info != NULL) {
+      snapshotString(out, sf.field_info - fis.data(), i, NULL, sf);
+      fits();
+    }
+  }
+  for (size_t i = 0; i < numeric_values_.size(); i++) {
+    for (auto &p : numeric_values_[i].expanded) {
+      snapshotNumeric(out, p.second.field_info - fis.data(), i, &p.first,
+                      p.second);
+      fits();
+    }
+  }
+  for (size_t i = 0; i < string_values_.size(); i++) {
+    for (auto &p : string_values_[i].expanded) {
+      snapshotString(out, p.second.field_info - fis.data(), i, &p.first,
+                     p.second);
+      fits();
+    }
+  }
+}
+
+int MeterCommonImplementation::restoreValues(const uchar *data, size_t len) {
+  std::vector<FieldInfo> &fis = *field_infos_;
+  if (len < SNAPSHOT_HEADER_SIZE || data[0] != SNAPSHOT_VERSION ||
+      restoreU32(data + 1) != snapshotLayout(fis))
+    return -1;
+
+  uint32_t ts = restoreU32(data + 5);
+  size_t pos = SNAPSHOT_HEADER_SIZE;
+  int restored = 0;
+  while (pos + 3 <= len) {
+    uchar flags = data[pos];
+    size_t index = data[pos + 1] | data[pos + 2] << 8;
+    pos += 3;
+    if (index >= fis.size())
+      return -1;
+    FieldInfo *fi = &fis[index];
+    // The field info owning the slot, the first one with the same name.
+    FieldInfo *sfi = fi;
+    if (flags & SNAPSHOT_SLOT) {
+      if (pos + 2 > len)
+        return -1;
+      size_t slot = data[pos] | data[pos + 1] << 8;
+      pos += 2;
+      if (slot >= fis.size())
+        return -1;
+      sfi = &fis[slot];
+    }
+
+    std::string name;
+    if (flags & SNAPSHOT_EXPANDED) {
+      if (pos >= len || pos + 1 + data[pos] > len)
+        return -1;
+      name.assign((const char *)data + pos + 1, data[pos]);
+      pos += 1 + data[pos];
+    }
+
+    if (flags & SNAPSHOT_STRING) {
+      if (pos >= len || pos + 1 + data[pos] > len)
+        return -1;
+      StringField sf(std::string((const char *)data + pos + 1, data[pos]), fi);
+      pos += 1 + data[pos];
+      if (name.empty())
+        ValueSlot<StringField>::store(&stringSlot(sfi).value, std::move(sf),
+                                      telegram_seq_);
+      else
+        stringSlot(fi).setExpanded(name, std::move(sf), telegram_seq_);
+      string_changes_++;
+    } else {
+      if (pos + 1 + sizeof(double) > len || data[pos] >= (uchar)Unit::Unknown)
+        return -1;
+      NumericField nf((Unit)data[pos], 0, fi);
+      memcpy(&nf.value, data + pos + 1, sizeof(double));
+      pos += 1 + sizeof(double);
+      if (name.empty())
+        ValueSlot<NumericField>::store(&numericSlot(sfi).value, std::move(nf),
+                                       telegram_seq_);
+      else
+        numericSlot(fi).setExpanded(name, std::move(nf), telegram_seq_);
+    }
+    restored++;
+  }
+
+  if (datetime_of_update_ == 0)
+    datetime_of_update_ = ts;
+  return restored;
+}
+
 FieldInfo::~FieldInfo() {}
 
 FieldInfo::FieldInfo(
@@ -1149,8 +1564,17 @@ FieldInfo::FieldInfo(
     warning("(meter) field template \"%s\" could not be parsed!\n",
             vname.c_str());
   }
+  field_name_is_template_ = vname.find('{') != std::string::npos;
+  field_name_cacheable_ = !field_name_->usesMeterFields();
 }
 
+size_t FieldInfo::field_name_cache_hits_ = 0;
+size_t FieldInfo::field_name_cache_misses_ = 0;
+
+// Historic values rarely use more than a handful of storage nrs per field,
+// but a telegram can contain any combination of storage/tariff/subunit.
+#define MAX_CACHED_FIELD_NAMES 64
+
 std::string FieldInfo::renderJsonOnlyDefaultUnit(Meter *m) {
   return renderJson(m, NULL);
 }
@@ -1160,67 +1584,99 @@ std::string FieldInfo::renderJsonText(Meter *m, DVEntry *dve) {
 }
 
 std::string FieldInfo::generateFieldNameNoUnit(Meter *m, DVEntry *dve) {
+  return std::string(fieldNameNoUnit(m, dve));
+}
+
+std::string FieldInfo::generateFieldNameWithUnit(Meter *m, DVEntry *dve) {
+  return std::string(fieldNameWithUnit(m, dve));
+}
+
+std::string_view FieldInfo::fieldNameNoUnit(Meter *m, DVEntry *dve) {
   if (!valid_field_name_)
     return "bad_field_name";
+  if (!field_name_is_template_)
+    return vname_;
 
-  return field_name_->apply(m, dve);
+  return lookupFieldName(m, dve).no_unit;
 }
 
-std::string FieldInfo::generateFieldNameWithUnit(Meter *m, DVEntry *dve) {
+std::string_view FieldInfo::fieldNameWithUnit(Meter *m, DVEntry *dve) {
   if (!valid_field_name_)
     return "bad_field_name";
+  if (!field_name_is_template_ && xuantity_ == Quantity::Text)
+    return vname_;
 
-  if (xuantity_ == Quantity::Text) {
-    return field_name_->apply(m, dve);
+  return lookupFieldName(m, dve).with_unit;
+}
+
+FieldInfo::FieldName &FieldInfo::lookupFieldName(Meter *m, DVEntry *dve) {
+  std::tuple<int, int, int> key(-1, -1, -1);
+  if (dve != NULL && field_name_is_template_) {
+    key = std::make_tuple(dve->storage_nr.intValue(), dve->tariff_nr.intValue(),
+                          dve->subunit_nr.intValue());
   }
 
-  std::string display_unit_s = unitToStringLowerCase(displayUnit());
-  std::string var = field_name_->apply(m, dve);
+  auto i = field_names_.find(key);
+  if (i != field_names_.end() && field_name_cacheable_) {
+    if (field_name_is_template_)
+      field_name_cache_hits_++;
+    return i->second;
+  }
+  if (field_name_is_template_)
+    field_name_cache_misses_++;
 
-  return var + "_" + display_unit_s;
+  if (i == field_names_.end()) {
+    if (field_names_.size() >= MAX_CACHED_FIELD_NAMES)
+      field_names_.clear();
+    i = field_names_.emplace(key, FieldName()).first;
+  }
+
+  FieldName &fn = i->second;
+  fn.no_unit = field_name_->apply(m, dve);
+  if (xuantity_ == Quantity::Text)
+    fn.with_unit = fn.no_unit;
+  else
+    fn.with_unit = fn.no_unit + "_" + unitToStringLowerCase(displayUnit());
+  return fn;
 }
 
 std::string FieldInfo::renderJson(Meter *m, DVEntry *dve) {
   std::string s;
+  JsonWriter w(&s);
+  writeJson(m, dve, &w);
+  return s;
+}
 
-  std::string display_unit_s = unitToStringLowerCase(displayUnit());
-  std::string field_name = generateFieldNameNoUnit(m, dve);
+void FieldInfo::writeJson(Meter *m, DVEntry *dve, JsonWriter *w) {
+  std::string_view field_name = fieldNameNoUnit(m, dve);
 
   if (xuantity() == Quantity::Text) {
     std::string v = m->getStringValue(this);
+    w->key(field_name);
     if (v == "null") {
       // Yes, right now a meter cannot send a string value "something":"null" it
       // will be translated into "something":null in the json, indicating that
       // there is no value. This should not be a problem for now. Lets deal with
       // it when a meter decides to send "null" as its version string for
       // example.
-      s += "\"" + field_name + "\":null";
+      w->null();
     } else {
-      // Normally the string values are quoted in json. TODO quote the value
-      // properly. A well crafted meter could send a version string with " and
-      // break the json format.
-      s += "\"" + field_name + "\":\"" + v + "\"";
+      w->string(v);
     }
   } else {
+    double v = m->getNumericValue(this, field_name, displayUnit());
+    w->key(fieldNameWithUnit(m, dve));
     if (displayUnit() == Unit::DateLT) {
-      s += "\"" + field_name + "_" + display_unit_s + "\":\"" +
-           strdate(m->getNumericValue(field_name, Unit::DateLT)) + "\"";
+      w->string(strdate(v));
     } else if (displayUnit() == Unit::DateTimeLT) {
-      s += "\"" + field_name + "_" + display_unit_s + "\":\"" +
-           strdatetime(m->getNumericValue(field_name, Unit::DateTimeLT)) + "\"";
+      w->string(strdatetime(v));
     } else if (displayUnit() == Unit::DateTimeUTC) {
-      s += "\"" + field_name + "_" + display_unit_s + "\":\"" +
-           strTimestampUTC(m->getNumericValue(field_name, Unit::DateTimeUTC)) +
-           "\"";
+      w->string(strTimestampUTC(v));
     } else {
       // All numeric values.
-      s += "\"" + field_name + "_" + display_unit_s + "\":" +
-           valueToString(m->getNumericValue(field_name, displayUnit()),
-                         displayUnit());
+      w->number(v);
     }
   }
-
-  return s;
 }
 
 void MeterCommonImplementation::createMeterEnv(
@@ -1246,122 +1702,34 @@ void MeterCommonImplementation::printMeter(
     char separator, std::string *json, std::vector<std::string> *envs,
     std::vector<std::string> *extra_constant_fields,
     std::vector<std::string> *selected_fields, bool pretty_print_json) {
-  bool first = !t->meter->hasReceivedFirstTelegram();
-
   if (human_readable)
-    *human_readable = concatFields(this, t, '\t', field_infos_, true,
+    *human_readable = concatFields(this, t, '\t', *field_infos_, true,
                                    selected_fields, extra_constant_fields);
   if (fields)
-    *fields = concatFields(this, t, separator, field_infos_, false,
+    *fields = concatFields(this, t, separator, *field_infos_, false,
                            selected_fields, extra_constant_fields);
 
-  std::string media;
-  if (t->tpl_id_found) {
-    media = mediaTypeJSON(t->tpl_type, t->tpl_mfct);
-  } else if (t->ell_id_found) {
-    media = mediaTypeJSON(t->ell_type, t->ell_mfct);
-  } else {
-    media = mediaTypeJSON(t->dll_type, t->dll_mfct);
-  }
-
-  std::string id = "";
-  if (t->addresses.size() > 0) {
-    id = build_id(t->addresses.back(), identityMode());
-  }
-
   if (json) {
-    std::string indent = "";
-    std::string newline = "";
-
-    if (pretty_print_json) {
-      indent = "    ";
-      newline = "\n";
-    }
-
-    std::string s;
-    s += "{" + newline;
-    s += indent + "\"_\":\"telegram\"," + newline;
-    s += indent + "\"media\":\"" + media + "\"," + newline;
-    s += indent + "\"meter\":\"" + driverName().str() + "\"," + newline;
-    s += indent + "\"name\":\"" + name() + "\"," + newline;
-    s += indent + "\"id\":\"" + id + "\"," + newline;
-
-    // Iterate over the meter field infos...
-    std::map<FieldInfo *, std::set<DVEntry *>>
-        founds; // Multiple dventries can match to a single field info.
-    std::set<std::string> found_vnames;
-
-    for (auto &p : numeric_values_) {
-      std::string vname = p.first.first;
-      NumericField &nf = p.second;
-      if (nf.field_info->printProperties().hasHIDE())
-        continue;
-
-      std::string out = nf.field_info->renderJson(this, &nf.dv_entry);
-      s += indent + out + "," + newline;
-
-      if (first && getDetailedFirst()) {
-        size_t pos = out.find("\":");
-        if (pos != std::string::npos) {
-          std::string rule = out.substr(0, pos) + "_field\":" +
-                             std::to_string(nf.field_info->index());
-          s += indent + rule + "," + newline;
-        }
-      }
-    }
-
-    for (auto &p : string_values_) {
-      std::string vname = p.first;
-      StringField &sf = p.second;
-      std::string out;
+    json->clear();
+    TelegramSummary summary(t);
+    writeJson(&summary, json, extra_constant_fields, pretty_print_json);
+  }
 
-      if (sf.field_info->printProperties().hasHIDE())
-        continue;
-      if (sf.field_info->printProperties().hasSTATUS()) {
-        std::string in = getStatusField(sf.field_info);
-        out = tostrprintf("\"%s\":\"%s\"", vname.c_str(), in.c_str());
-        s += indent + out + "," + newline;
-      } else {
-        if (sf.value == "null") {
-          // The string "null" translates to actual json null.
-          out = tostrprintf("\"%s\":null", vname.c_str());
-          s += indent + out + "," + newline;
-        } else {
-          out = tostrprintf("\"%s\":\"%s\"", vname.c_str(), sf.value.c_str());
-          s += indent + out + "," + newline;
-        }
-      }
-      if (first && getDetailedFirst()) {
-        size_t pos = out.find("\":");
-        if (pos != std::string::npos) {
-          std::string rule = out.substr(0, pos) + "_field\":" +
-                             std::to_string(sf.field_info->index());
-          s += indent + rule + "," + newline;
-        }
-      }
+  if (envs) {
+    std::string media;
+    if (t->tpl_id_found) {
+      media = mediaTypeJSON(t->tpl_type, t->tpl_mfct);
+    } else if (t->ell_id_found) {
+      media = mediaTypeJSON(t->ell_type, t->ell_mfct);
+    } else {
+      media = mediaTypeJSON(t->dll_type, t->dll_mfct);
     }
-    s += indent + "\"timestamp\":\"" + datetimeOfUpdateRobot() + "\"";
 
-    if (t->about.device != "") {
-      s += "," + newline;
-      s += indent + "\"device\":\"" + t->about.device + "\"," + newline;
-      s += indent + "\"rssi_dbm\":" + std::to_string(t->about.rssi_dbm);
+    std::string id = "";
+    if (t->addresses.size() > 0) {
+      id = build_id(t->addresses.back(), identityMode());
     }
-    for (std::string extra_field : meterExtraConstantFields()) {
-      s += "," + newline;
-      s += indent + makeQuotedJson(extra_field);
-    }
-    if (extra_constant_fields)
-      for (std::string extra_field : *extra_constant_fields) {
-        s += "," + newline;
-        s += indent + makeQuotedJson(extra_field);
-      }
-    s += newline;
-    s += "}";
-    *json = s;
-  }
 
-  if (envs) {
     createMeterEnv(id, envs, extra_constant_fields);
 
     envs->push_back(std::string("METER_JSON=") + *json);
@@ -1374,7 +1742,7 @@ void MeterCommonImplementation::printMeter(
     envs->push_back(std::string("METER_TIMESTAMP_LT=") +
                     datetimeOfUpdateHumanReadable());
 
-    for (FieldInfo &fi : field_infos_) {
+    for (FieldInfo &fi : *field_infos_) {
       if (fi.printProperties().hasHIDE())
         continue;
 
@@ -1401,6 +1769,89 @@ void MeterCommonImplementation::printMeter(
   }
 }
 
+void MeterCommonImplementation::writeJson(
+    TelegramSummary *t, std::string *json,
+    std::vector<std::string> *extra_constant_fields, bool pretty_print_json,
+    bool changed_only) {
+  bool first = !hasReceivedFirstTelegram();
+  bool detailed = first && getDetailedFirst() && !changed_only;
+
+  JsonWriter w(json, pretty_print_json);
+  w.beginObject();
+  w.key("_");
+  w.string(changed_only ? "delta" : "telegram");
+  if (!changed_only) {
+    w.key("media");
+    w.string(mediaTypeJSON(t->type, t->mfct));
+    w.key("meter");
+    w.string(driverName().str());
+  }
+  w.key("name");
+  w.string(name());
+  w.key("id");
+  if (t->has_address)
+    w.string(build_id(t->address, identityMode()));
+  else
+    w.string("");
+
+  for (auto &p : sortedNumericValues()) {
+    NumericField &nf = *p.second;
+    if (nf.field_info->printProperties().hasHIDE())
+      continue;
+    if (changed_only && nf.changed_seq != telegram_seq_)
+      continue;
+
+    nf.field_info->writeJson(this, &nf.dv_entry, &w);
+    if (detailed) {
+      w.key(nf.field_info->fieldNameWithUnit(this, &nf.dv_entry), "_field");
+      w.integer(nf.field_info->index());
+    }
+  }
+
+  for (auto &p : sortedStringValues()) {
+    const std::string &vname = *p.first;
+    StringField &sf = *p.second;
+
+    if (sf.field_info->printProperties().hasHIDE())
+      continue;
+    if (changed_only && sf.changed_seq != telegram_seq_)
+      continue;
+    w.key(vname);
+    if (sf.field_info->printProperties().hasSTATUS()) {
+      w.string(getStatusField(sf.field_info));
+    } else if (sf.value == "null") {
+      // The string "null" translates to actual json null.
+      w.null();
+    } else {
+      w.string(sf.value);
+    }
+    if (detailed) {
+      w.key(vname, "_field");
+      w.integer(sf.field_info->index());
+    }
+  }
+  w.key("timestamp");
+  w.string(datetimeOfUpdateRobot());
+
+  if (changed_only) {
+    w.endObject();
+    return;
+  }
+
+  if (t->about.device != "") {
+    w.key("device");
+    w.string(t->about.device);
+    w.key("rssi_dbm");
+    w.integer(t->about.rssi_dbm);
+  }
+  for (std::string &extra_field : meterExtraConstantFields())
+    w.keyValue(extra_field);
+  if (extra_constant_fields)
+    for (std::string &extra_field : *extra_constant_fields)
+      w.keyValue(extra_field);
+  w.endObject();
+}
+
 void MeterCommonImplementation::setExpectedTPLSecurityMode(
     TPLSecurityMode tsm) {
   expected_tpl_sec_mode_ = tsm;
@@ -1421,20 +1872,16 @@ ELLSecurityMode MeterCommonImplementation::expectedELLSecurityMode() {
 
 void detectMeterDrivers(int manufacturer, int media, int version,
                         std::vector<std::string> *drivers) {
-  for (DriverInfo *p : allDrivers()) {
-    if (p->detect(manufacturer, media, version)) {
-      drivers->push_back(p->name().str());
-    }
+  for (DriverInfo *p : detectedDrivers(manufacturer, media, version)) {
+    drivers->push_back(p->name().str());
   }
 }
 
 bool isMeterDriverValid(DriverName driver_name, int manufacturer, int media,
                         int version) {
-  for (DriverInfo *p : allDrivers()) {
-    if (p->detect(manufacturer, media, version)) {
-      if (p->hasDriverName(driver_name))
-        return true;
-    }
+  for (DriverInfo *p : detectedDrivers(manufacturer, media, version)) {
+    if (p->hasDriverName(driver_name))
+      return true;
   }
 
   return false;
@@ -1445,35 +1892,102 @@ bool isMeterDriverReasonableForMedia(std::string driver_name, int media) {
     return false; // Skip converter meter side since they do not give any useful
                   // information.
 
-  for (DriverInfo *p : allDrivers()) {
-    if (p->name().str() == driver_name && p->isValidMedia(media)) {
-      return true;
-    }
-  }
-
-  return false;
+  DriverInfo *p = lookupDriver(driver_name);
+  return p != NULL && p->name().str() == driver_name && p->isValidMedia(media);
 }
 
 DriverInfo driver_unknown_;
 
+static const std::vector<DriverInfo *> &detectedDrivers(Telegram *t) {
+  if (t->tpl_id_found)
+    return detectedDrivers(t->tpl_mfct, t->tpl_type, t->tpl_version);
+  return detectedDrivers(t->dll_mfct, t->dll_type, t->dll_version);
+}
+
 DriverInfo pickMeterDriver(Telegram *t) {
-  int manufacturer = t->dll_mfct;
-  int media = t->dll_type;
-  int version = t->dll_version;
+  auto &drivers = detectedDrivers(t);
+  if (!drivers.empty()) {
+    return *drivers.front();
+  }
+
+  return driver_unknown_;
+}
+
+// Number of telegram sources for which the picked driver is remembered.
+#define PICKED_DRIVER_CACHE_SIZE 64
+
+typedef std::tuple<std::string, uint16_t, uchar, uchar> PickedDriverKey;
+// The picked driver and when it was last used, the least recently used one
+// is forgotten when the cache is full.
+std::map<PickedDriverKey, std::pair<DriverInfo *, uint32_t>> picked_drivers_;
+uint32_t picked_drivers_uses_ = 0;
+
+static void rememberPickedDriver(const PickedDriverKey &key, DriverInfo *p) {
+  if (picked_drivers_.count(key) == 0 &&
+      picked_drivers_.size() >= PICKED_DRIVER_CACHE_SIZE) {
+    auto lru = picked_drivers_.begin();
+    for (auto i = picked_drivers_.begin(); i != picked_drivers_.end(); i++) {
+      if (i->second.second < lru->second.second)
+        lru = i;
+    }
+    picked_drivers_.erase(lru);
+  }
+  picked_drivers_[key] = {p, ++picked_drivers_uses_};
+}
+
+static bool pickedDriverKey(Telegram *t, PickedDriverKey *key) {
+  if (t->addresses.empty())
+    return false;
+  Address &a = t->addresses.back();
+  *key = PickedDriverKey(a.id, a.mfct, a.version, a.type);
+  return true;
+}
 
-  if (t->tpl_id_found) {
-    manufacturer = t->tpl_mfct;
-    media = t->tpl_type;
-    version = t->tpl_version;
+DriverInfo *pickMeterDriverCached(Telegram *t) {
+  PickedDriverKey key;
+  if (!pickedDriverKey(t, &key))
+    return NULL;
+
+  auto i = picked_drivers_.find(key);
+  if (i != picked_drivers_.end()) {
+    i->second.second = ++picked_drivers_uses_;
+    return i->second.first;
   }
 
-  for (DriverInfo *p : allDrivers()) {
-    if (p->detect(manufacturer, media, version)) {
-      return *p;
+  DriverInfo di = pickMeterDriver(t);
+  DriverInfo *p = di.name().str() == "" ? NULL : lookupDriver(di.name().str());
+
+  rememberPickedDriver(key, p);
+
+  verbose("(meter) picked driver %s for %s\n",
+          p ? p->name().str().c_str() : "unknown",
+          t->addresses.back().str().c_str());
+  return p;
+}
+
+void rejectPickedMeterDriver(Telegram *t, DriverInfo *failed) {
+  PickedDriverKey key;
+  if (!pickedDriverKey(t, &key))
+    return;
+
+  // Pick the candidate after the failed one, starting over after the last.
+  auto &drivers = detectedDrivers(t);
+  if (drivers.empty() || failed == NULL)
+    return;
+  size_t next = 0;
+  for (size_t i = 0; i < drivers.size(); i++) {
+    if (drivers[i]->name().str() == failed->name().str()) {
+      next = (i + 1) % drivers.size();
+      break;
     }
   }
+  DriverInfo *p = lookupDriver(drivers[next]->name().str());
 
-  return driver_unknown_;
+  rememberPickedDriver(key, p);
+
+  verbose("(meter) driver %s failed for %s, next pick %s\n",
+          failed->name().str().c_str(), t->addresses.back().str().c_str(),
+          p ? p->name().str().c_str() : "unknown");
 }
 
 std::shared_ptr<Meter> createMeter(MeterInfo *mi) {
@@ -1655,7 +2169,7 @@ void FieldInfo::performExtraction(Meter *m, Telegram *t, DVEntry *dve) {
 void FieldInfo::performCalculation(Meter *m) {
   assert(hasFormula());
 
-  double value = formula_->calculate(displayUnit());
+  double value = formula_->calculate(displayUnit(), NULL, m);
   m->setNumericValue(this, NULL, displayUnit(), value);
 }
 
@@ -1698,7 +2212,7 @@ bool FieldInfo::extractNumeric(Meter *m, Telegram *t, DVEntry *dve) {
   assert(dve != NULL);
   assert(key == "" || dve->dif_vif_key.str() == key);
 
-  std::string field_name = generateFieldNameWithUnit(m, dve);
+  std::string_view field_name = fieldNameWithUnit(m, dve);
 
   double extracted_double_value = NAN;
 
@@ -1730,8 +2244,9 @@ bool FieldInfo::extractNumeric(Meter *m, Telegram *t, DVEntry *dve) {
       decoded_unit = toDefaultUnit(matcher_.vif_range);
     }
 
-    debug("(meter) %s %s decoded %s default %s value %g (scale %g)\n",
-          toString(matcher_.vif_range), field_name.c_str(),
+    debug("(meter) %s %.*s decoded %s default %s value %g (scale %g)\n",
+          toString(matcher_.vif_range), (int)field_name.size(),
+          field_name.data(),
           unitToStringLowerCase(decoded_unit).c_str(),
           unitToStringLowerCase(display_unit_).c_str(), extracted_double_value,
           scale());
@@ -1824,16 +2339,13 @@ bool FieldInfo::extractString(Meter *m, Telegram *t, DVEntry *dve) {
   assert(dve != NULL);
   assert(key == "" || dve->dif_vif_key.str() == key);
 
-  // Generate the json field name:
-  std::string field_name = generateFieldNameNoUnit(m, dve);
-
   uint64_t extracted_bits{};
-  if (lookup_.hasLookups() || (print_properties_.hasINCLUDETPLSTATUS())) {
+  if (lookup().hasLookups() || (print_properties_.hasINCLUDETPLSTATUS())) {
     std::string translated_bits = "";
     // The field has lookups, or the print property JOIN_TPL_STATUS is set,
     // this means that we should create a string.
-    if (lookup_.hasLookups() && dve->extractLong(&extracted_bits)) {
-      translated_bits = lookup().translate(extracted_bits);
+    if (lookup().hasLookups() && dve->extractLong(&extracted_bits)) {
+      translated_bits = lookup_.translate(extracted_bits);
       found = true;
     }
 
@@ -28,8 +28,12 @@
 
 #include <assert.h>
 #include <functional>
+#include <map>
+#include <memory>
 #include <numeric>
 #include <string>
+#include <string_view>
+#include <tuple>
 #include <vector>
 
 #define LIST_OF_METER_TYPES                                                    \
@@ -153,6 +157,8 @@ struct MeterInfo {
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
+struct FieldInfo;
+
 struct DriverDetect {
   uint16_t mfct;
   uchar type;
@@ -176,6 +182,8 @@ private:
       -1; // Used for meters not declaring mfct specific data using the dif 0f.
   bool has_process_content_ =
       false; // Mark this driver as having mfct specific decoding.
+  std::shared_ptr<std::vector<FieldInfo>>
+      field_infos_; // Built by the first meter, then shared by all meters.
 
 public:
   ~DriverInfo();
@@ -222,6 +230,10 @@ public:
   bool isCloseEnoughMedia(uchar type);
   int forceMfctIndex() { return force_mfct_index_; }
   bool hasProcessContent() { return has_process_content_; }
+  std::shared_ptr<std::vector<FieldInfo>> fieldInfos() { return field_infos_; }
+  void setFieldInfos(std::shared_ptr<std::vector<FieldInfo>> f) {
+    field_infos_ = f;
+  }
 };
 
 bool registerDriver(std::function<void(DriverInfo &di)> setup);
@@ -230,6 +242,12 @@ DriverInfo *lookupDriver(std::string name);
 bool lookupDriverInfo(const std::string &driver, DriverInfo *di = NULL);
 // Return the best driver match for a telegram.
 DriverInfo pickMeterDriver(Telegram *t);
+// As above, but the choice is remembered per (address, mfct, version, type)
+// so that detection runs only for the first telegram. NULL if no driver fits.
+DriverInfo *pickMeterDriverCached(Telegram *t);
+// The driver found nothing it knows in this telegram, remember the next
+// candidate driver for its source instead, if there is another one.
+void rejectPickedMeterDriver(Telegram *t, DriverInfo *failed);
 // Return true for mbus and S2/C2/T2 drivers.
 bool driverNeedsPolling(DriverName &dn);
 
@@ -313,7 +331,7 @@ struct FieldInfo {
             Translate::Lookup lookup, Formula *formula, Meter *m);
 
   int index() { return index_; }
-  std::string vname() { return vname_; }
+  const std::string &vname() { return vname_; }
   Quantity xuantity() { return xuantity_; }
   Unit displayUnit() { return display_unit_; }
   VifScaling vifScaling() { return vif_scaling_; }
@@ -334,6 +352,8 @@ struct FieldInfo {
 
   std::string renderJsonOnlyDefaultUnit(Meter *m);
   std::string renderJson(Meter *m, DVEntry *dve);
+  // Write the "name_unit":value member of this field.
+  void writeJson(Meter *m, DVEntry *dve, JsonWriter *w);
   std::string renderJsonText(Meter *m, DVEntry *dve);
   // Render the field name based on the actual field from the telegram.
   // A FieldInfo can be declared to handle any number of storage fields of a
@@ -342,10 +362,18 @@ struct FieldInfo {
   // nr 2.)
   std::string generateFieldNameWithUnit(Meter *m, DVEntry *dve);
   std::string generateFieldNameNoUnit(Meter *m, DVEntry *dve);
+  // As above, but the names are cached per storage/tariff/subunit nr and
+  // the returned views stay valid until the cache is reset. The cache is reset
+  // only when full and is shared by all meters using this field info.
+  std::string_view fieldNameWithUnit(Meter *m, DVEntry *dve);
+  std::string_view fieldNameNoUnit(Meter *m, DVEntry *dve);
+  // Total hits and misses of the field name caches of all field infos.
+  static size_t fieldNameCacheHits() { return field_name_cache_hits_; }
+  static size_t fieldNameCacheMisses() { return field_name_cache_misses_; }
   // Check if the meter object stores a value for this field.
   bool hasValue(Meter *m);
 
-  Translate::Lookup &lookup() { return lookup_; }
+  Translate::Lookup &lookup() { return lookup_.lookup; }
 
   std::string str();
 
@@ -354,6 +382,13 @@ struct FieldInfo {
     index_ = -1;
   }
 
+  int numericSlot() { return numeric_slot_; }
+  int stringSlot() { return string_slot_; }
+  void setValueSlots(int numeric_slot, int string_slot) {
+    numeric_slot_ = numeric_slot;
+    string_slot_ = string_slot;
+  }
+
 private:
   int index_;         // The field infos for a meter are ordered.
   std::string vname_; // Value name, like: total current previous target, ie no
@@ -384,7 +419,7 @@ private:
                                   // c++ object
 
   // Lookup bits to strings.
-  Translate::Lookup lookup_;
+  Translate::CachedLookup lookup_;
 
   // For calculated fields.
   std::shared_ptr<Formula> formula_;
@@ -395,10 +430,41 @@ private:
   // If the field name template could not be parsed.
   bool valid_field_name_{};
 
+  // If the field name has {...} formulas and if they only depend on the
+  // counters of the dventry, ie the names can be cached.
+  bool field_name_is_template_{};
+  bool field_name_cacheable_{};
+
+  struct FieldName {
+    std::string no_unit;
+    std::string with_unit;
+  };
+  // Generated field names keyed on storage, tariff and subunit nr.
+  std::map<std::tuple<int, int, int>, FieldName> field_names_;
+  FieldName &lookupFieldName(Meter *m, DVEntry *dve);
+
+  static size_t field_name_cache_hits_;
+  static size_t field_name_cache_misses_;
+
+  // Where the meter stores the values of this field, -1 until first used.
+  int numeric_slot_ = -1;
+  int string_slot_ = -1;
+
   // If true then this field was fetched from the library.
   bool from_library_{};
 };
 
+// How far handleTelegram got with a telegram.
+enum class TelegramStage {
+  HEADER,  // The header could not be parsed or the telegram is for another
+           // meter.
+  PARSE,   // Decryption or parsing failed, which does not depend on the
+           // driver, eg because of a wrong key or a bad crc.
+  CONTENT, // Parsed, but the driver found none of its fields among the dv
+           // entries of the telegram.
+  HANDLED
+};
+
 struct Meter {
   // Meters are instantiated on the fly from a template, when a telegram arrives
   // and no exact meter exists. Index 1 is the first meter created etc.
@@ -435,6 +501,9 @@ struct Meter {
                                double v) = 0;
   virtual double getNumericValue(std::string vname, Unit u) = 0;
   virtual double getNumericValue(FieldInfo *fi, Unit u) = 0;
+  virtual double getNumericValue(FieldInfo *fi,
+                                 std::string_view field_name_no_unit,
+                                 Unit u) = 0;
   virtual void setStringValue(FieldInfo *fi, std::string v, DVEntry *dve) = 0;
   virtual void setStringValue(std::string vname, std::string v,
                               DVEntry *dve = NULL) = 0;
@@ -451,15 +520,26 @@ struct Meter {
                           std::vector<std::string> *more_json,
                           std::vector<std::string> *selected_fields,
                           bool pretty_print_json) = 0;
+  // Append the json of the last telegram to the caller owned buffer, same
+  // content as the json from printMeter. With changed_only, only the values
+  // that changed with the last telegram are written together with name, id
+  // and timestamp, and "_" is "delta" instead of "telegram".
+  virtual void writeJson(TelegramSummary *t, std::string *json,
+                         std::vector<std::string> *more_json,
+                         bool pretty_print_json,
+                         bool changed_only = false) = 0;
 
   // The handleTelegram expects an input_frame where the DLL crcs have been
   // removed. Returns true of this meter handled this telegram! Sets id_match to
   // true, if there was an id match, even though the telegram could not be
-  // properly handled.
+  // properly handled. If out_t is given, it must be a fresh telegram and the
+  // telegram is parsed into it. If stage is given, it is set to how far the
+  // telegram got.
   virtual bool handleTelegram(AboutTelegram &about,
                               std::vector<uchar> input_frame, bool simulated,
                               std::vector<Address> *addresses, bool *id_match,
-                              Telegram *out_t = NULL) = 0;
+                              Telegram *out_t = NULL,
+                              TelegramStage *stage = NULL) = 0;
   virtual MeterKeys *meterKeys() = 0;
 
   virtual void addExtraCalculatedField(std::string ecf) = 0;
@@ -473,10 +553,21 @@ struct Meter {
                                                 Quantity xuantity) = 0;
 
   virtual std::string debugValues() = 0;
+  // Append a compact binary copy of the stored values, that can be given to
+  // restoreValues of a meter using the same driver, eg after a reboot.
+  // Values that would make the snapshot longer than max_len are left out,
+  // the expanded ones (eg total_at_month_3) first. The snapshot starts with
+  // SNAPSHOT_HEADER_SIZE bytes, holding the time of the last update.
+  virtual void snapshotValues(std::vector<uchar> *out, size_t max_len) = 0;
+  // Returns the number of restored values, or -1 if the snapshot is not for
+  // this driver.
+  virtual int restoreValues(const uchar *data, size_t len) = 0;
 
   virtual ~Meter() = default;
 };
 
+const size_t SNAPSHOT_HEADER_SIZE = 9;
+
 const char *toString(MeterType type);
 MeterType toMeterType(std::string type);
 std::string toString(DriverInfo &driver);
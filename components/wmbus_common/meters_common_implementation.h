@@ -22,6 +22,7 @@
 #include "meters.h"
 #include "units.h"
 
+#include <cmath>
 #include <map>
 #include <set>
 
@@ -42,6 +43,13 @@ struct NumericField {
       : unit(u), value(v), field_info(f) {}
   NumericField(Unit u, double v, FieldInfo *f, DVEntry &dve)
       : unit(u), value(v), field_info(f), dv_entry(dve) {}
+
+  // The telegram (counted by the meter) where the value last changed.
+  uint32_t changed_seq{};
+  bool sameValue(const NumericField &o) const {
+    return unit == o.unit &&
+           (value == o.value || (std::isnan(value) && std::isnan(o.value)));
+  }
 };
 
 struct StringField {
@@ -50,6 +58,47 @@ struct StringField {
 
   StringField() {}
   StringField(std::string v, FieldInfo *f) : value(v), field_info(f) {}
+
+  // The telegram (counted by the meter) where the value last changed.
+  uint32_t changed_seq{};
+  bool sameValue(const StringField &o) const { return value == o.value; }
+};
+
+// The values of a meter are stored in slots indexed by the position of the
+// field info in the driver's field infos. Field infos with the same vname
+// (and display unit for numeric values) share the slot of the first one.
+// Field names generated from the dventry, like total_at_month_2 from
+// total_at_month_{storage_counter}, are stored in the expanded array unless
+// a field info with that vname exists.
+template <typename T> struct ValueSlot {
+  T value; // Unset while value.field_info is NULL.
+  std::vector<std::pair<std::string, T>> expanded;
+
+  T *findExpanded(std::string_view field_name_no_unit) {
+    for (auto &p : expanded) {
+      if (p.first == field_name_no_unit)
+        return &p.second;
+    }
+    return NULL;
+  }
+
+  bool setExpanded(std::string_view field_name_no_unit, T &&v, uint32_t seq) {
+    T *found = findExpanded(field_name_no_unit);
+    if (found != NULL)
+      return store(found, std::move(v), seq);
+    v.changed_seq = seq;
+    expanded.emplace_back(std::string(field_name_no_unit), std::move(v));
+    return true;
+  }
+
+  // Store v into dst, keeping the changed_seq of dst if the value is the same.
+  // Returns true if the value changed.
+  static bool store(T *dst, T &&v, uint32_t seq) {
+    bool same = dst->field_info != NULL && dst->sameValue(v);
+    v.changed_seq = same ? dst->changed_seq : seq;
+    *dst = std::move(v);
+    return !same;
+  }
 };
 
 struct MeterCommonImplementation : public virtual Meter {
@@ -102,6 +151,17 @@ protected:
   void setMfctTPLStatusBits(Translate::Lookup &lookup);
 
   void markLastFieldAsLibrary();
+  void useOwnFieldInfos();
+  void assignValueSlots(FieldInfo *fi);
+  ValueSlot<NumericField> &numericSlot(FieldInfo *fi);
+  ValueSlot<StringField> &stringSlot(FieldInfo *fi);
+  FieldInfo *findValueField(FieldInfo *fi,
+                            std::string_view field_name_no_unit);
+  // All stored values sorted on field name (and unit), ie the print order.
+  std::vector<std::pair<const std::string *, NumericField *>>
+  sortedNumericValues();
+  std::vector<std::pair<const std::string *, StringField *>>
+  sortedStringValues();
 
   void addNumericFieldWithExtractor(
       std::string vname, // Name of value without unit, eg "total"
@@ -175,7 +235,8 @@ protected:
 
   bool handleTelegram(AboutTelegram &about, std::vector<uchar> frame,
                       bool simulated, std::vector<Address> *addresses,
-                      bool *id_match, Telegram *out_analyzed = NULL);
+                      bool *id_match, Telegram *out_analyzed = NULL,
+                      TelegramStage *stage = NULL);
   void createMeterEnv(std::string id, std::vector<std::string> *envs,
                       std::vector<std::string>
                           *more_json); // Add this json "key"="value" strings.
@@ -186,6 +247,9 @@ protected:
           *more_json, // Add this json "key"="value" strings.
       std::vector<std::string> *selected_fields, // Only print these fields.
       bool pretty_print); // Insert newlines and indentation.
+  void writeJson(TelegramSummary *t, std::string *json,
+                 std::vector<std::string> *more_json, bool pretty_print,
+                 bool changed_only = false);
   // Json fields include all values except timestamp_ut, timestamp_utc,
   // timestamp_lt since Json is assumed to be decoded by a program and the
   // current timestamp which is the same as timestamp_utc, can always be
@@ -194,8 +258,11 @@ protected:
   FieldInfo *findFieldInfo(std::string vname, Quantity xuantity);
   std::string renderJsonOnlyDefaultUnit(std::string vname, Quantity xuantity);
   std::string debugValues();
+  void snapshotValues(std::vector<uchar> *out, size_t max_len);
+  int restoreValues(const uchar *data, size_t len);
 
-  void processFieldExtractors(Telegram *t);
+  // Returns the number of fields extracted from dv entries.
+  size_t processFieldExtractors(Telegram *t);
   void processFieldCalculators();
   std::string getStatusField(FieldInfo *fi);
 
@@ -205,6 +272,8 @@ protected:
   void setNumericValue(FieldInfo *fi, DVEntry *dve, Unit u, double v);
   double getNumericValue(std::string vname, Unit u);
   double getNumericValue(FieldInfo *fi, Unit u);
+  double getNumericValue(FieldInfo *fi, std::string_view field_name_no_unit,
+                         Unit u);
   void setStringValue(std::string vname, std::string v, DVEntry *dve = NULL);
   void setStringValue(FieldInfo *fi, std::string v, DVEntry *dve);
   std::string getStringValue(FieldInfo *fi);
@@ -249,9 +318,24 @@ private:
   int force_mfct_index_ = -1;
   bool has_process_content_ = false;
   bool has_received_first_telegram_ = false;
+  // Counts the handled telegrams, used to find the values that changed.
+  uint32_t telegram_seq_{};
+  // Bumped whenever a string value changes. The joined and sorted status
+  // field is only rendered again when this has moved since the last render.
+  uint32_t string_changes_{};
+  uint32_t status_rendered_at_{};
+  FieldInfo *status_rendered_fi_{};
+  std::string status_rendered_;
+  // The last decoded tpl status byte, -1 if none.
+  int tpl_sts_decoded_ = -1;
+  std::string tpl_status_;
 
 protected:
-  std::vector<FieldInfo> field_infos_;
+  // Shared with all other meters using the same driver, see fieldInfos() in
+  // DriverInfo. Copied by useOwnFieldInfos() before adding meter specific
+  // fields.
+  std::shared_ptr<std::vector<FieldInfo>> field_infos_;
+  bool shares_driver_fields_{};
   // This is the number of fields in the driver, not counting the used library
   // fields.
   size_t num_driver_fields_{};
@@ -260,12 +344,10 @@ protected:
   // meter file. There is also a global selected_fields that can be set on the
   // command line or in the conf file.
   std::vector<std::string> selected_fields_;
-  // Map difvif key to hex values from telegrams.
-  std::map<std::string, std::pair<int, std::string>> hex_values_;
-  // Map field name+Unit to Numeric field which includes the value.
-  std::map<std::pair<std::string, Unit>, NumericField> numeric_values_;
-  // Map field name (at_date) to string value.
-  std::map<std::string, StringField> string_values_;
+  // Numeric values indexed by FieldInfo::numericSlot().
+  std::vector<ValueSlot<NumericField>> numeric_values_;
+  // String values indexed by FieldInfo::stringSlot().
+  std::vector<ValueSlot<StringField>> string_values_;
   // If the telegram ends with 0x1f then set this to true, and the poll
   // code will poll again with 0x7b instead of 0x5b.
   bool more_records_follow_;
@@ -215,6 +215,16 @@ std::string Lookup::translate(uint64_t bits) {
   return sortStatusString(total);
 }
 
+std::string CachedLookup::translate(uint64_t bits) {
+  if (translated_valid_ && translated_bits_ == bits)
+    return translated_;
+
+  translated_ = lookup.translate(bits);
+  translated_bits_ = bits;
+  translated_valid_ = true;
+  return translated_;
+}
+
 std::string Lookup::str() {
   std::string x = " Lookup {\n";
 
@@ -131,6 +131,21 @@ struct Lookup {
 
   std::string str();
 };
+
+// The bits of a status field rarely change between telegrams, a lookup that
+// remembers its last translation to avoid rebuilding the same string. Kept
+// apart from Lookup, so that drivers can brace initialize the rules.
+struct CachedLookup {
+  Lookup lookup;
+
+  CachedLookup(Lookup l) : lookup(l) {}
+  std::string translate(uint64_t bits);
+
+private:
+  bool translated_valid_ = false;
+  uint64_t translated_bits_{};
+  std::string translated_;
+};
 }; // namespace Translate
 
 Translate::MapType toMapType(const char *s);
@@ -169,30 +169,59 @@ bool overrideConversion(Unit from, Unit to) {
   return false;
 }
 
-bool canConvert(Unit ufrom, Unit uto) {
-  if (ufrom == uto)
-    return true;
+// The conversions above as functions, index 0 means no conversion.
+typedef double (*UnitConversion)(double vfrom);
+
+static constexpr UnitConversion unit_conversions_[] = {
+    nullptr,
 #define X(from, to, code)                                                      \
-  if (Unit::from == ufrom && Unit::to == uto)                                  \
-    return true;
-  LIST_OF_CONVERSIONS
+  [](double vfrom) {                                                           \
+    double vto = -4711.0;                                                      \
+    code return vto;                                                           \
+  },
+    LIST_OF_CONVERSIONS
 #undef X
-  return false;
-}
+};
 
-double convert(double vfrom, Unit ufrom, Unit uto) {
-  double vto = -4711.0;
-  if (ufrom == uto) {
-    { vto = vfrom; }
-    return vto;
-  }
+static_assert(sizeof(unit_conversions_) / sizeof(UnitConversion) <= 256,
+              "Too many unit conversions for a uint8_t index!");
+
+#define NUM_UNITS ((int)Unit::Unknown + 1)
 
+// For every pair of units, the index of the conversion function, built when
+// compiling from LIST_OF_CONVERSIONS.
+struct UnitConversionTable {
+  uint8_t index[NUM_UNITS][NUM_UNITS];
+};
+
+static constexpr UnitConversionTable buildUnitConversionTable() {
+  UnitConversionTable t{};
+  int i = 0;
 #define X(from, to, code)                                                      \
-  if (Unit::from == ufrom && Unit::to == uto) {                                \
-    code return vto;                                                           \
-  }
+  i++;                                                                         \
+  if (t.index[(int)Unit::from][(int)Unit::to] == 0)                            \
+    t.index[(int)Unit::from][(int)Unit::to] = i;
   LIST_OF_CONVERSIONS
 #undef X
+  return t;
+}
+
+static constexpr UnitConversionTable unit_conversion_table_ =
+    buildUnitConversionTable();
+
+bool canConvert(Unit ufrom, Unit uto) {
+  if (ufrom == uto)
+    return true;
+  return unit_conversion_table_.index[(int)ufrom][(int)uto] != 0;
+}
+
+double convert(double vfrom, Unit ufrom, Unit uto) {
+  if (ufrom == uto)
+    return vfrom;
+
+  uint8_t i = unit_conversion_table_.index[(int)ufrom][(int)uto];
+  if (i != 0)
+    return unit_conversions_[i](vfrom);
 
   std::string from = unitToStringHR(ufrom);
   std::string to = unitToStringHR(uto);
@@ -233,9 +262,24 @@ void getScaleOffset(const SIExp &e, double *scale, double *offset) {
 
 bool SIUnit::convertTo(double left, const SIUnit &out_siunit,
                        double *out) const {
-  if (exp() == out_siunit.exp()) {
+  SIConversion c;
+  if (!conversionTo(out_siunit, &c)) {
     if (out != NULL)
-      *out = (left * scale_) / out_siunit.scale_;
+      *out = std::numeric_limits<double>::quiet_NaN();
+    return false;
+  }
+
+  if (out != NULL)
+    *out = c.apply(left);
+  return true;
+}
+
+bool SIUnit::conversionTo(const SIUnit &out_siunit, SIConversion *out) const {
+  if (exp() == out_siunit.exp()) {
+    out->pre_offset = 0;
+    out->mul = scale_;
+    out->div = out_siunit.scale_;
+    out->post_offset = 0;
     return true;
   }
 
@@ -253,13 +297,13 @@ bool SIUnit::convertTo(double left, const SIUnit &out_siunit,
     getScaleOffset(out_siunit.exp(), &to_scale, &to_offset);
     to_scale *= out_siunit.scale();
 
-    if (out != NULL)
-      *out = ((left + from_offset) * from_scale) / to_scale - to_offset;
+    out->pre_offset = from_offset;
+    out->mul = from_scale;
+    out->div = to_scale;
+    out->post_offset = to_offset;
     return true;
   }
 
-  if (out != NULL)
-    *out = std::numeric_limits<double>::quiet_NaN();
   return false;
 }
 
@@ -279,6 +279,28 @@ private:
 
 enum class MathOp { ADD, SUB };
 
+// The constants of a unit conversion: out = ((in + pre_offset) * mul) / div -
+// post_offset. Zero offsets are skipped to give bit identical results with a
+// plain scaling.
+struct SIConversion {
+  double pre_offset{};
+  double mul = 1.0;
+  double div = 1.0;
+  double post_offset{};
+
+  double apply(double v) const {
+    if (pre_offset != 0)
+      v += pre_offset;
+    v = (v * mul) / div;
+    if (post_offset != 0)
+      v -= post_offset;
+    return v;
+  }
+  bool isIdentity() const {
+    return pre_offset == 0 && mul == 1.0 && div == 1.0 && post_offset == 0;
+  }
+};
+
 struct SIUnit {
   // Transform a double,double,uint64_t into an SIUnit.
   // The exp can be created compile time like this: SIUNIT(3.6E6, 0,
@@ -312,6 +334,9 @@ struct SIUnit {
   // Convert value from this unit to another unit and store it in out. Return
   // false if conversion is impossible!
   bool convertTo(double left, const SIUnit &out_siunit, double *out) const;
+  // Store the constants used by convertTo into out. Return false if
+  // conversion is impossible!
+  bool conversionTo(const SIUnit &out_siunit, SIConversion *out) const;
   // Do a math op. Store the resulting unit and value into the destination
   // pointers. Return false if the addion cannot be performed.
   bool mathOpTo(MathOp op, double left, double right,
@@ -707,6 +707,124 @@ std::string makeQuotedJson(const std::string &s) {
   return std::string("\"") + key + "\":\"" + value + "\"";
 }
 
+void JsonWriter::beginObject() {
+  *out_ += '{';
+  if (pretty_print_)
+    *out_ += '\n';
+  first_ = true;
+}
+
+void JsonWriter::endObject() {
+  if (pretty_print_)
+    *out_ += '\n';
+  *out_ += '}';
+}
+
+void JsonWriter::key(std::string_view k, std::string_view suffix) {
+  if (!first_) {
+    *out_ += ',';
+    if (pretty_print_)
+      *out_ += '\n';
+  }
+  first_ = false;
+  if (pretty_print_)
+    *out_ += "    ";
+  *out_ += '"';
+  escaped(k);
+  escaped(suffix);
+  *out_ += "\":";
+}
+
+void JsonWriter::string(std::string_view v) {
+  *out_ += '"';
+  escaped(v);
+  *out_ += '"';
+}
+
+void JsonWriter::number(double v) {
+  if (::isnan(v)) {
+    null();
+    return;
+  }
+  // Same as std::to_string followed by stripping trailing zeros.
+  char buf[64];
+  int n = snprintf(buf, sizeof(buf), "%f", v);
+  if (n < 0 || n >= (int)sizeof(buf)) {
+    std::string s = std::to_string(v);
+    n = s.size();
+    while (n > 0 && s[n - 1] == '0')
+      n--;
+    if (n > 0 && s[n - 1] == '.')
+      n--;
+    if (n == 0)
+      *out_ += '0';
+    else
+      out_->append(s, 0, n);
+    return;
+  }
+  while (n > 0 && buf[n - 1] == '0')
+    n--;
+  if (n > 0 && buf[n - 1] == '.')
+    n--;
+  if (n == 0)
+    *out_ += '0';
+  else
+    out_->append(buf, n);
+}
+
+void JsonWriter::integer(long long v) {
+  char buf[24];
+  int n = snprintf(buf, sizeof(buf), "%lld", v);
+  out_->append(buf, n);
+}
+
+void JsonWriter::null() { *out_ += "null"; }
+
+void JsonWriter::keyValue(std::string_view s) {
+  size_t p = s.find('=');
+  if (p != std::string_view::npos) {
+    key(s.substr(0, p));
+    string(s.substr(p + 1));
+  } else {
+    key(s);
+    string("");
+  }
+}
+
+void JsonWriter::escaped(std::string_view s) {
+  size_t start = 0;
+  for (size_t i = 0; i < s.size(); i++) {
+    unsigned char c = s[i];
+    if (c != '"' && c != '\\' && c >= 0x20)
+      continue;
+    out_->append(s.data() + start, i - start);
+    start = i + 1;
+    switch (c) {
+    case '"':
+      *out_ += "\\\"";
+      break;
+    case '\\':
+      *out_ += "\\\\";
+      break;
+    case '\n':
+      *out_ += "\\n";
+      break;
+    case '\r':
+      *out_ += "\\r";
+      break;
+    case '\t':
+      *out_ += "\\t";
+      break;
+    default: {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      *out_ += buf;
+    }
+    }
+  }
+  out_->append(s.data() + start, s.size() - start);
+}
+
 std::string currentYear() {
   char datetime[40];
   memset(datetime, 0, sizeof(datetime));
@@ -24,6 +24,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "esphome/core/log.h"
@@ -180,6 +181,35 @@ bool startsWith(const std::string &s, std::string &prefix);
 // Given alfa=beta it returns "alfa":"beta"
 std::string makeQuotedJson(const std::string &s);
 
+// Appends json to a caller owned buffer, without building temporary strings.
+// Members are separated by commas (and newlines/indentation when pretty
+// printing). Without a beginObject, the members are written as a fragment,
+// like "total_m3":123.
+struct JsonWriter {
+  JsonWriter(std::string *out, bool pretty_print = false)
+      : out_(out), pretty_print_(pretty_print) {}
+
+  void beginObject();
+  void endObject();
+  // Start a new member, the key is the concatenation of the parts.
+  void key(std::string_view k, std::string_view suffix = {});
+  // Quoted and escaped string value.
+  void string(std::string_view v);
+  // Number formatted like valueToString, nan is written as null.
+  void number(double v);
+  void integer(long long v);
+  void null();
+  // Given alfa=beta it writes the member "alfa":"beta"
+  void keyValue(std::string_view s);
+
+private:
+  void escaped(std::string_view s);
+
+  std::string *out_;
+  bool pretty_print_;
+  bool first_ = true;
+};
+
 std::string currentYear();
 std::string currentYearMonth();
 std::string currentYearMonthDay();
@@ -180,28 +180,45 @@ struct Manufacturer {
   const char *code;
   int m_field;
   const char *name;
-
-  Manufacturer(const char *c, int m, const char *n) {
-    code = c;
-    m_field = m;
-    name = n;
-  }
 };
 
-std::vector<Manufacturer> manufacturers_;
+// Define WMBUS_NO_MANUFACTURER_NAMES to leave the long manufacturer names out
+// of the firmware, the three letter code is then reported as the name.
+#ifdef WMBUS_NO_MANUFACTURER_NAMES
+#define X(key, code, name) {#key, code, #key},
+#else
+#define X(key, code, name) {#key, code, name},
+#endif
+static constexpr Manufacturer manufacturers_[] = {LIST_OF_MANUFACTURERS};
+#undef X
 
-struct Initializer {
-  Initializer();
-};
+static constexpr size_t num_manufacturers_ =
+    sizeof(manufacturers_) / sizeof(manufacturers_[0]);
 
-static Initializer initializser_;
+static constexpr bool manufacturersAreSorted() {
+  for (size_t i = 1; i < num_manufacturers_; i++) {
+    if (manufacturers_[i - 1].m_field > manufacturers_[i].m_field)
+      return false;
+  }
+  return true;
+}
 
-Initializer::Initializer() {
+static_assert(manufacturersAreSorted(),
+              "LIST_OF_MANUFACTURERS must be sorted by MANFCODE");
 
-#define X(key, code, name)                                                     \
-  manufacturers_.push_back(Manufacturer(#key, code, name));
-  LIST_OF_MANUFACTURERS
-#undef X
+// Binary search, returns the first entry when a code is listed twice.
+static const Manufacturer *findManufacturer(int m_field) {
+  size_t lo = 0, hi = num_manufacturers_;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (manufacturers_[mid].m_field < m_field)
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  if (lo < num_manufacturers_ && manufacturers_[lo].m_field == m_field)
+    return &manufacturers_[lo];
+  return NULL;
 }
 
 void Telegram::addAddressMfctFirst(const std::vector<uchar>::iterator &pos) {
@@ -233,7 +250,7 @@ void Telegram::print() {
 
   notice("Received telegram from: %02x%02x%02x%02x\n", a, b, c, d);
   notice("          manufacturer: (%s) %s (0x%02x)\n",
-         manufacturerFlag(dll_mfct).c_str(), manufacturer(dll_mfct).c_str(),
+         manufacturerFlag(dll_mfct).c_str(), manufacturer(dll_mfct),
          dll_mfct);
   notice("                  type: %s (0x%02x)%s\n",
          mediaType(dll_type, dll_mfct).c_str(), dll_type, enc);
@@ -244,7 +261,7 @@ void Telegram::print() {
     notice("      Concerning meter: %02x%02x%02x%02x\n", tpl_id_b[3],
            tpl_id_b[2], tpl_id_b[1], tpl_id_b[0]);
     notice("          manufacturer: (%s) %s (0x%02x)\n",
-           manufacturerFlag(tpl_mfct).c_str(), manufacturer(tpl_mfct).c_str(),
+           manufacturerFlag(tpl_mfct).c_str(), manufacturer(tpl_mfct),
            tpl_mfct);
     notice("                  type: %s (0x%02x)%s\n",
            mediaType(tpl_type, dll_mfct).c_str(), tpl_type, enc);
@@ -335,19 +352,13 @@ void Telegram::printTPL() {
   }
 }
 
-std::string manufacturer(int m_field) {
-  for (auto &m : manufacturers_) {
-    if (m.m_field == m_field)
-      return m.name;
-  }
+const char *manufacturer(int m_field) {
+  const Manufacturer *m = findManufacturer(m_field);
   // Some weird meters send the first char in lower case aPT iTW. Fix and try
   // again.
-  m_field &= 0x7fff;
-  for (auto &m : manufacturers_) {
-    if (m.m_field == m_field)
-      return m.name;
-  }
-  return "Unknown";
+  if (m == NULL)
+    m = findManufacturer(m_field & 0x7fff);
+  return m != NULL ? m->name : "Unknown";
 }
 
 std::string mediaType(int a_field_device_type, int m_field) {
@@ -900,8 +911,7 @@ void Telegram::addExplanationAndIncrementPos(std::vector<uchar>::iterator &pos,
   vsnprintf(buf, 1023, fmt, args);
   va_end(args);
 
-  Explanation e(parsed.size(), len, buf, k, u);
-  explanations.push_back(e);
+  explanations.emplace_back(parsed.size(), len, buf, k, u);
   parsed.insert(parsed.end(), pos, pos + len);
   pos += len;
 }
@@ -917,8 +927,8 @@ void Telegram::setExplanation(std::vector<uchar>::iterator &pos, int len,
   vsnprintf(buf, 1023, fmt, args);
   va_end(args);
 
-  Explanation e(std::distance(frame.begin(), pos), len, buf, k, u);
-  explanations.push_back(e);
+  explanations.emplace_back(std::distance(frame.begin(), pos), len, buf, k,
+                            u);
 }
 
 void Telegram::addMoreExplanation(int pos, std::string json) {
@@ -939,7 +949,7 @@ void Telegram::addMoreExplanation(int pos, const char *fmt, ...) {
   for (auto &p : explanations) {
     if (p.pos == pos) {
       // Append more information.
-      p.info = p.info + buf;
+      p.info += buf;
       // Since we are adding more information, we assume that we have a full
       // understanding.
       p.understanding = Understanding::FULL;
@@ -964,7 +974,7 @@ void Telegram::addSpecialExplanation(int offset, int len, KindOfData k,
   vsnprintf(buf, 1023, fmt, args);
   va_end(args);
 
-  explanations.push_back({offset, len, buf, k, u});
+  explanations.emplace_back(offset, len, buf, k, u);
 }
 
 bool expectedMore(int line) {
@@ -1284,7 +1294,7 @@ bool Telegram::parseELL(std::vector<uchar>::iterator &pos) {
                   ell_pl_crc_b[0], ell_pl_crc_b[1], check & 0xff, check >> 8,
                   dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
                   manufacturerFlag(dll_mfct).c_str(),
-                  manufacturer(dll_mfct).c_str(), dll_mfct,
+                  manufacturer(dll_mfct), dll_mfct,
                   mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
         }
       }
@@ -1726,7 +1736,7 @@ bool Telegram::potentiallyDecrypt(std::vector<uchar>::iterator &pos) {
                 "ver: 0x%02x\n",
                 dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
                 manufacturerFlag(dll_mfct).c_str(),
-                manufacturer(dll_mfct).c_str(), dll_mfct,
+                manufacturer(dll_mfct), dll_mfct,
                 mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
         return false;
       }
@@ -1759,7 +1769,7 @@ bool Telegram::potentiallyDecrypt(std::vector<uchar>::iterator &pos) {
                   "mfct: (%s) %s (0x%02x) type: %s (0x%02x) ver: 0x%02x\n",
                   dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
                   manufacturerFlag(dll_mfct).c_str(),
-                  manufacturer(dll_mfct).c_str(), dll_mfct,
+                  manufacturer(dll_mfct), dll_mfct,
                   mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
         }
       }
@@ -1795,7 +1805,7 @@ bool Telegram::potentiallyDecrypt(std::vector<uchar>::iterator &pos) {
                   "mfct: (%s) %s (0x%02x) type: %s (0x%02x) ver: 0x%02x\n",
                   dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
                   manufacturerFlag(dll_mfct).c_str(),
-                  manufacturer(dll_mfct).c_str(), dll_mfct,
+                  manufacturer(dll_mfct), dll_mfct,
                   mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
         }
       }
@@ -1814,7 +1824,7 @@ bool Telegram::potentiallyDecrypt(std::vector<uchar>::iterator &pos) {
                 "ver: 0x%02x\n",
                 dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
                 manufacturerFlag(dll_mfct).c_str(),
-                manufacturer(dll_mfct).c_str(), dll_mfct,
+                manufacturer(dll_mfct), dll_mfct,
                 mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
         return false;
       }
@@ -1836,7 +1846,7 @@ bool Telegram::potentiallyDecrypt(std::vector<uchar>::iterator &pos) {
                   "mfct: (%s) %s (0x%02x) type: %s (0x%02x) ver: 0x%02x\n",
                   dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
                   manufacturerFlag(dll_mfct).c_str(),
-                  manufacturer(dll_mfct).c_str(), dll_mfct,
+                  manufacturer(dll_mfct), dll_mfct,
                   mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
           return false;
         }
@@ -1894,7 +1904,7 @@ bool Telegram::potentiallyDecrypt(std::vector<uchar>::iterator &pos) {
                   "mfct: (%s) %s (0x%02x) type: %s (0x%02x) ver: 0x%02x\n",
                   dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
                   manufacturerFlag(dll_mfct).c_str(),
-                  manufacturer(dll_mfct).c_str(), dll_mfct,
+                  manufacturer(dll_mfct), dll_mfct,
                   mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
         }
       }
@@ -1925,7 +1935,7 @@ bool Telegram::potentiallyDecrypt(std::vector<uchar>::iterator &pos) {
         "id: %02x%02x%02x%02x mfct: (%s) %s (0x%02x) type: %s (0x%02x) ver: "
         "0x%02x\n",
         dll_id_b[3], dll_id_b[2], dll_id_b[1], dll_id_b[0],
-        manufacturerFlag(dll_mfct).c_str(), manufacturer(dll_mfct).c_str(),
+        manufacturerFlag(dll_mfct).c_str(), manufacturer(dll_mfct),
         dll_mfct, mediaType(dll_type, dll_mfct).c_str(), dll_type, dll_version);
     return false;
   }
@@ -2107,6 +2117,14 @@ void Telegram::preProcess() {
 
 bool Telegram::parse(std::vector<uchar> &input_frame, MeterKeys *mk,
                      bool warn) {
+  // The known drivers explain about 0.6 bytes of a telegram per explanation,
+  // and no telegram needs more than 0.83. Reserve room for most up front,
+  // the arena does not reuse the storage left behind by a growing vector.
+  // Not done for the header alone, which most meters stop at when the
+  // telegram is for another meter.
+  explanations.reserve(input_frame.size() * 3 / 4);
+  parsed.reserve(input_frame.size());
+
   switch (about.type) {
   case FrameType::WMBUS:
     return parseWMBUS(input_frame, mk, warn);
@@ -2119,6 +2137,49 @@ bool Telegram::parse(std::vector<uchar> &input_frame, MeterKeys *mk,
   return false;
 }
 
+TelegramArena::TelegramArena(size_t size)
+    : buffer_(new std::byte[size]), resource_(buffer_.get(), size, &overflow_) {
+}
+
+void TelegramArena::release() {
+  resource_.release();
+  used_ = 0;
+}
+
+void *TelegramArena::do_allocate(size_t bytes, size_t alignment) {
+  used_ += bytes;
+  return resource_.allocate(bytes, alignment);
+}
+
+void *TelegramArena::Overflow::do_allocate(size_t bytes, size_t alignment) {
+  allocated += bytes;
+  return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void TelegramArena::Overflow::do_deallocate(void *p, size_t bytes,
+                                            size_t alignment) {
+  allocated -= bytes;
+  std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+}
+
+TelegramSummary::TelegramSummary(Telegram *t)
+    : about(t->about), tpl_sts(t->tpl_sts), tpl_acc(t->tpl_acc) {
+  if (t->addresses.size() > 0) {
+    address = t->addresses.back();
+    has_address = true;
+  }
+  if (t->tpl_id_found) {
+    type = t->tpl_type;
+    mfct = t->tpl_mfct;
+  } else if (t->ell_id_found) {
+    type = t->ell_type;
+    mfct = t->ell_mfct;
+  } else {
+    type = t->dll_type;
+    mfct = t->dll_mfct;
+  }
+}
+
 bool Telegram::parseHeader(std::vector<uchar> &input_frame) {
   switch (about.type) {
   case FrameType::WMBUS:
@@ -2352,7 +2413,7 @@ void Telegram::explainParse(std::string intro, int from) {
   }
 }
 
-std::string renderAnalysisAsText(std::vector<Explanation> &explanations,
+std::string renderAnalysisAsText(std::pmr::vector<Explanation> &explanations,
                                  OutputFormat of) {
   std::string s;
 
@@ -2417,7 +2478,7 @@ std::string renderAnalysisAsText(std::vector<Explanation> &explanations,
   return s;
 }
 
-std::string renderAnalysisAsJson(std::vector<Explanation> &explanations) {
+std::string renderAnalysisAsJson(std::pmr::vector<Explanation> &explanations) {
   return "{ \"TODO\": true }\n";
 }
 
@@ -25,8 +25,18 @@
 #include "util.h"
 
 #include <inttypes.h>
+#include <cstddef>
 #include <map>
+#include <memory>
+#include <memory_resource>
 #include <set>
+#include <string_view>
+
+// Size of the buffer of a TelegramArena, enough for most telegrams. What does
+// not fit is allocated from the heap until the arena is released.
+#ifndef TELEGRAM_ARENA_SIZE
+#define TELEGRAM_ARENA_SIZE 16384
+#endif
 
 // Check and remove the data link layer CRCs from a wmbus telegram.
 // If the CRCs do not pass the test, return false.
@@ -306,14 +316,64 @@ enum class KindOfData { PROTOCOL, CONTENT };
 enum class Understanding { NONE, ENCRYPTED, COMPRESSED, PARTIAL, FULL };
 
 struct Explanation {
+  // The explanations of a telegram, and their texts, are allocated from the
+  // arena of the telegram.
+  typedef std::pmr::polymorphic_allocator<char> allocator_type;
+
   int pos{};
   int len{};
-  std::string info;
+  std::pmr::string info;
   KindOfData kind{};
   Understanding understanding{};
 
-  Explanation(int p, int l, const std::string &i, KindOfData k, Understanding u)
-      : pos(p), len(l), info(i), kind(k), understanding(u) {}
+  Explanation(int p, int l, std::string_view i, KindOfData k, Understanding u,
+              const allocator_type &a = {})
+      : pos(p), len(l), info(i, a), kind(k), understanding(u) {}
+  Explanation(const Explanation &e, const allocator_type &a)
+      : pos(e.pos), len(e.len), info(e.info, a), kind(e.kind),
+        understanding(e.understanding) {}
+  Explanation(Explanation &&e, const allocator_type &a)
+      : pos(e.pos), len(e.len), info(std::move(e.info), a), kind(e.kind),
+        understanding(e.understanding) {}
+};
+
+// Bump allocator for the containers filled while parsing telegrams, the
+// explanations and the dv entries. It is kept by whoever parses telegram after
+// telegram, eg the radio, so its buffer is allocated once. Nothing is freed
+// until release(), which must only be called when the telegrams using the
+// arena are gone. Values copied into the meter are allocated from the heap.
+class TelegramArena : public std::pmr::memory_resource {
+public:
+  explicit TelegramArena(size_t size = TELEGRAM_ARENA_SIZE);
+
+  void release();
+  // Bytes allocated from the arena since it was last released.
+  size_t used() { return used_; }
+  // Bytes of those that did not fit the buffer and came from the heap.
+  size_t overflow() { return overflow_.allocated; }
+
+private:
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *, size_t, size_t) override {}
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  // Counts the blocks the arena allocates from the heap when its buffer is
+  // full.
+  struct Overflow : public std::pmr::memory_resource {
+    size_t allocated{};
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const memory_resource &other) const noexcept override {
+      return this == &other;
+    }
+  };
+
+  std::unique_ptr<std::byte[]> buffer_;
+  Overflow overflow_;
+  std::pmr::monotonic_buffer_resource resource_;
+  size_t used_{};
 };
 
 struct Meter;
@@ -324,6 +384,11 @@ private:
 
 public:
   Telegram() = default;
+  // The explanations and dv entries are allocated from arena, which must
+  // outlive the telegram. Without one they are allocated from the heap.
+  explicit Telegram(TelegramArena *arena) : arena(arena) {}
+
+  std::pmr::memory_resource *arena = std::pmr::get_default_resource();
 
   AboutTelegram about;
 
@@ -472,7 +537,7 @@ public:
 
   // A vector of indentations and explanations, to be printed
   // below the raw data bytes to explain the telegram content.
-  std::vector<Explanation> explanations;
+  std::pmr::vector<Explanation> explanations{arena};
   void addExplanationAndIncrementPos(std::vector<uchar>::iterator &pos, int len,
                                      KindOfData k, Understanding u,
                                      const char *fmt, ...);
@@ -496,7 +561,7 @@ public:
 
   // The actual content of the (w)mbus telegram. The DifVif entries.
   // Mapped from their key for quick access to their offset and content.
-  std::map<std::string, std::pair<int, DVEntry>> dv_entries;
+  DVEntries dv_entries{arena};
 
   std::string autoDetectPossibleDrivers();
 
@@ -548,6 +613,26 @@ private:
   findFormatBytesFromKnownMeterSignatures(std::vector<uchar> *format_bytes);
 };
 
+// The parts of a handled telegram needed to render the meter values after the
+// telegram itself, with its frame, explanations and dv entries, is released.
+struct TelegramSummary {
+  AboutTelegram about;
+  // Not known from the telegram, set by the receiver.
+  LinkMode link_mode{LinkMode::UNKNOWN};
+  // The last address found, i.e. the tpl address if there is one. It is the
+  // address the meter id is built from.
+  Address address;
+  bool has_address{};
+  // Media and manufacturer from the tpl, ell or dll, in that order.
+  uchar type{};
+  int mfct{};
+  int tpl_sts{};
+  int tpl_acc{};
+
+  TelegramSummary() = default;
+  explicit TelegramSummary(Telegram *t);
+};
+
 struct SendBusContent {
   LinkMode link_mode;
   TelegramFormat format;
@@ -560,7 +645,7 @@ struct SendBusContent {
 
 struct Meter;
 
-std::string manufacturer(int m_field);
+const char *manufacturer(int m_field);
 std::string mediaType(int a_field_device_type, int m_field);
 std::string mediaTypeJSON(int a_field_device_type, int m_field);
 bool isCiFieldOfType(int ci_field, CI_TYPE type);
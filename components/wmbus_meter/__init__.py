@@ -21,6 +21,11 @@ from ..wmbus_common import validate_driver
 CONF_METER_ID = "meter_id"
 CONF_RADIO_ID = "radio_id"
 CONF_ON_TELEGRAM = "on_telegram"
+CONF_PERSIST_DRIVER = "persist_driver"
+CONF_PERSIST_VALUES = "persist_values"
+CONF_PERSIST_INTERVAL = "persist_interval"
+CONF_JSON_DELTA = "json_delta"
+CONF_JSON_FULL_EVERY = "json_full_every"
 
 CODEOWNERS = ["@SzczepanLeon", "@kubasaw"]
 
@@ -48,7 +53,32 @@ def hex_key_validator(key):
         raise cv.Invalid(e.msg.replace("Bind key", "Key"))
 
 
-CONFIG_SCHEMA = cv.Schema(
+def validate_persist_driver(config):
+    if config[CONF_PERSIST_DRIVER] and config[CONF_TYPE] != "auto":
+        raise cv.Invalid(
+            f"'{CONF_PERSIST_DRIVER}' is only supported with type 'auto'")
+    return config
+
+
+def validate_persist_values(config):
+    if (
+        config[CONF_PERSIST_VALUES]
+        and config[CONF_TYPE] == "auto"
+        and not config[CONF_PERSIST_DRIVER]
+    ):
+        raise cv.Invalid(
+            f"'{CONF_PERSIST_VALUES}' with type 'auto' requires '{CONF_PERSIST_DRIVER}'")
+    return config
+
+
+def validate_json_delta(config):
+    if CONF_JSON_FULL_EVERY in config and not config[CONF_JSON_DELTA]:
+        raise cv.Invalid(
+            f"'{CONF_JSON_FULL_EVERY}' requires '{CONF_JSON_DELTA}'")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(cv.Schema(
     {
         cv.GenerateID(): cv.declare_id(Meter),
         cv.GenerateID(CONF_RADIO_ID): cv.use_id(RadioComponent),
@@ -62,6 +92,13 @@ CONFIG_SCHEMA = cv.Schema(
         cv.Optional(CONF_ON_TELEGRAM): automation.validate_automation(
             {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(TelegramTrigger)},
         ),
+        cv.Optional(CONF_PERSIST_DRIVER, default=False): cv.boolean,
+        cv.Optional(CONF_PERSIST_VALUES, default=False): cv.boolean,
+        cv.Optional(
+            CONF_PERSIST_INTERVAL, default="10min"
+        ): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_JSON_DELTA, default=False): cv.boolean,
+        cv.Optional(CONF_JSON_FULL_EVERY): cv.int_range(min=1),
         cv.Optional(CONF_MODE, default="Any"): cv.ensure_list(
             cv.enum(
                 {name: getattr(link_mode_enum, name)
@@ -69,7 +106,8 @@ CONFIG_SCHEMA = cv.Schema(
             )
         ),
     }
-).extend(cv.COMPONENT_SCHEMA)
+).extend(cv.COMPONENT_SCHEMA), validate_persist_driver,
+    validate_persist_values, validate_json_delta)
 
 
 async def to_code(config):
@@ -83,6 +121,16 @@ async def to_code(config):
         )
     )
 
+    if config[CONF_PERSIST_DRIVER]:
+        cg.add(meter.set_persist_driver(True))
+
+    if config[CONF_PERSIST_VALUES]:
+        cg.add(meter.set_persist_values(True))
+        cg.add(meter.set_persist_interval(config[CONF_PERSIST_INTERVAL]))
+
+    if config[CONF_JSON_DELTA]:
+        cg.add(meter.set_json_delta(config.get(CONF_JSON_FULL_EVERY, 10)))
+
     radio = await cg.get_variable(config[CONF_RADIO_ID])
     cg.add(meter.set_radio(radio))
     await cg.register_component(meter, config)
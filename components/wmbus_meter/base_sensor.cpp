@@ -1,17 +1,65 @@
 #include "base_sensor.h"
+#include "esphome/core/hal.h"
 #include "esphome/core/log.h"
 
+#include <cinttypes>
+
 namespace esphome {
 namespace wmbus_meter {
 static const char *TAG = "wmbus_meter.base_sensor";
 
 void BaseSensor::set_field_name(std::string field_name) {
   this->field_name = field_name;
+  this->binding_.field_name = field_name;
+}
+
+void BaseSensor::setup() {
+  // With auto detection the fields are not known until the driver is.
+  if (this->parent_->bind_field(&this->binding_) ||
+      this->parent_->is_auto_driver())
+    return;
+
+  ESP_LOGE(TAG, "Field '%s' is not provided by driver %s",
+           this->field_name.c_str(), this->parent_->get_driver().c_str());
+  this->mark_failed();
+}
+
+bool BaseSensor::should_publish(bool changed) {
+  uint32_t now = millis();
+  uint32_t since_last = now - this->last_publish_;
+
+  if (!this->publish_on_change_)
+    changed = true;
+
+  bool publish = !this->published_ ||
+                 (changed && since_last >= this->min_interval_) ||
+                 (this->max_interval_ != 0 && since_last >= this->max_interval_);
+  if (!publish) {
+    this->suppressed_count_++;
+    return false;
+  }
+
+  this->published_ = true;
+  this->last_publish_ = now;
+  return true;
+}
+
+void BaseSensor::dump_publish_config(const char *tag) {
+  if (this->publish_on_change_)
+    ESP_LOGCONFIG(tag, "  Publish on change: YES");
+  if (this->min_interval_ != 0)
+    ESP_LOGCONFIG(tag, "  Min interval: %" PRIu32 " ms", this->min_interval_);
+  if (this->max_interval_ != 0)
+    ESP_LOGCONFIG(tag, "  Max interval: %" PRIu32 " ms", this->max_interval_);
+  if (this->suppressed_count_ != 0)
+    ESP_LOGCONFIG(tag, "  Suppressed publishes: %" PRIu32,
+                  this->suppressed_count_);
 }
 
 void BaseSensor::set_parent(Meter *parent) {
   Parented::set_parent(parent);
   this->parent_->on_telegram([this]() { this->handle_update(); });
+  this->parent_->on_restore([this]() { this->handle_update(); });
 }
 } // namespace wmbus_meter
 } // namespace esphome
\ No newline at end of file
@@ -11,9 +11,33 @@ public:
   void set_field_name(std::string field_name);
   virtual void handle_update() = 0;
   void set_parent(Meter *parent);
+  void setup() override;
+
+  void set_publish_on_change(bool publish_on_change) {
+    this->publish_on_change_ = publish_on_change;
+  }
+  void set_min_interval(uint32_t min_interval) {
+    this->min_interval_ = min_interval;
+  }
+  void set_max_interval(uint32_t max_interval) {
+    this->max_interval_ = max_interval;
+  }
+  uint32_t get_suppressed_count() { return this->suppressed_count_; }
 
 protected:
   std::string field_name;
+  FieldBinding binding_;
+
+  // Decide if a new state is published, counts it as suppressed otherwise.
+  bool should_publish(bool changed);
+  void dump_publish_config(const char *tag);
+
+  bool publish_on_change_ = false;
+  uint32_t min_interval_ = 0;
+  uint32_t max_interval_ = 0;
+  bool published_ = false;
+  uint32_t last_publish_ = 0;
+  uint32_t suppressed_count_ = 0;
 };
 } // namespace wmbus_meter
 } // namespace esphome
\ No newline at end of file
@@ -4,6 +4,9 @@ from . import Meter, wmbus_meter_ns
 
 CONF_PARENT_ID = "parent_id"
 CONF_FIELD = "field"
+CONF_PUBLISH_ON_CHANGE = "publish_on_change"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_MAX_INTERVAL = "max_interval"
 
 BaseSensor = wmbus_meter_ns.class_("BaseSensor", cg.Component)
 
@@ -11,12 +14,32 @@ BASE_SCHEMA = cv.Schema(
     {
         cv.Required(CONF_PARENT_ID): cv.use_id(Meter),
         cv.Required(CONF_FIELD): cv.string_strict,
+        cv.Optional(CONF_PUBLISH_ON_CHANGE, default=False): cv.boolean,
+        cv.Optional(CONF_MIN_INTERVAL): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_MAX_INTERVAL): cv.positive_time_period_milliseconds,
     }
 )
 
 
+def validate_intervals(config):
+    if (
+        CONF_MIN_INTERVAL in config
+        and CONF_MAX_INTERVAL in config
+        and config[CONF_MAX_INTERVAL] < config[CONF_MIN_INTERVAL]
+    ):
+        raise cv.Invalid(
+            f"'{CONF_MAX_INTERVAL}' must not be shorter than '{CONF_MIN_INTERVAL}'"
+        )
+    return config
+
+
 async def register_meter(obj, config):
     meter = await cg.get_variable(config[CONF_PARENT_ID])
     await cg.register_parented(obj, meter)
     cg.add(obj.set_field_name(config[CONF_FIELD]))
+    cg.add(obj.set_publish_on_change(config[CONF_PUBLISH_ON_CHANGE]))
+    if CONF_MIN_INTERVAL in config:
+        cg.add(obj.set_min_interval(config[CONF_MIN_INTERVAL]))
+    if CONF_MAX_INTERVAL in config:
+        cg.add(obj.set_max_interval(config[CONF_MAX_INTERVAL]))
     await cg.register_component(obj, config)
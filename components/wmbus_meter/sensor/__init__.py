@@ -1,12 +1,22 @@
 from esphome import config_validation as cv
+import esphome.codegen as cg
 from esphome.components import sensor
 from esphome.const import CONF_UNIT_OF_MEASUREMENT
 
 from .. import wmbus_meter_ns
-from ..base_sensor import BASE_SCHEMA, register_meter, BaseSensor, CONF_FIELD
+from ..base_sensor import (
+    BASE_SCHEMA,
+    register_meter,
+    validate_intervals,
+    BaseSensor,
+    CONF_FIELD,
+    CONF_PUBLISH_ON_CHANGE,
+)
 from ...wmbus_common.units import get_human_readable_unit
 
 
+CONF_CHANGE_THRESHOLD = "change_threshold"
+
 RegularSensor = wmbus_meter_ns.class_("Sensor", BaseSensor, sensor.Sensor)
 
 
@@ -19,12 +29,25 @@ def default_unit_of_measurement(config):
     return config
 
 
+def change_threshold_implies_publish_on_change(config):
+    if CONF_CHANGE_THRESHOLD in config:
+        config[CONF_PUBLISH_ON_CHANGE] = True
+
+    return config
+
+
 CONFIG_SCHEMA = cv.All(
-    BASE_SCHEMA.extend(sensor.sensor_schema(RegularSensor)),
+    BASE_SCHEMA.extend(sensor.sensor_schema(RegularSensor)).extend(
+        {cv.Optional(CONF_CHANGE_THRESHOLD): cv.positive_float}
+    ),
     default_unit_of_measurement,
+    change_threshold_implies_publish_on_change,
+    validate_intervals,
 )
 
 
 async def to_code(config):
     sensor_ = await sensor.new_sensor(config)
     await register_meter(sensor_, config)
+    if CONF_CHANGE_THRESHOLD in config:
+        cg.add(sensor_.set_change_threshold(config[CONF_CHANGE_THRESHOLD]))
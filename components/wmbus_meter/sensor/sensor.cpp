@@ -5,9 +5,21 @@ namespace wmbus_meter {
 static const char *TAG = "wmbus_meter.sensor";
 
 void Sensor::handle_update() {
-  auto val = this->parent_->get_numeric_field(this->field_name);
-  if (val.has_value())
-    this->publish_state(*val);
+  auto val = this->parent_->get_numeric_field(&this->binding_);
+  if (!val.has_value())
+    return;
+
+  // Compared with the last published value, so slow drifts add up.
+  float delta = std::fabs(*val - this->last_value_);
+  bool changed = std::isnan(this->last_value_) ||
+                 (this->change_threshold_ == 0
+                      ? delta != 0
+                      : delta >= this->change_threshold_);
+  if (!this->should_publish(changed))
+    return;
+
+  this->last_value_ = *val;
+  this->publish_state(*val);
 }
 
 void Sensor::dump_config() {
@@ -15,6 +27,11 @@ void Sensor::dump_config() {
   ESP_LOGCONFIG(TAG, "  Parent meter ID: 0x%s",
                 this->parent_->get_id().c_str());
   ESP_LOGCONFIG(TAG, "  Field: '%s'", this->field_name.c_str());
+  if (this->is_failed())
+    ESP_LOGE(TAG, "  Field is not provided by the meter driver!");
+  if (this->change_threshold_ != 0)
+    ESP_LOGCONFIG(TAG, "  Change threshold: %.3f", this->change_threshold_);
+  this->dump_publish_config(TAG);
   LOG_SENSOR("  ", "Name:", this);
 }
 } // namespace wmbus_meter
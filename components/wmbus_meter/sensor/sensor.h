@@ -3,12 +3,22 @@
 
 #include "../base_sensor.h"
 
+#include <cmath>
+
 namespace esphome {
 namespace wmbus_meter {
 class Sensor : public sensor::Sensor, public BaseSensor {
 public:
   void handle_update();
   void dump_config() override;
+
+  void set_change_threshold(float change_threshold) {
+    this->change_threshold_ = change_threshold;
+  }
+
+protected:
+  float change_threshold_ = 0;
+  float last_value_ = NAN;
 };
 } // namespace wmbus_meter
 } // namespace esphome
@@ -1,12 +1,21 @@
+from esphome import config_validation as cv
 from esphome.components import text_sensor
 
 from .. import wmbus_meter_ns
-from ..base_sensor import BASE_SCHEMA, register_meter, BaseSensor
+from ..base_sensor import (
+    BASE_SCHEMA,
+    register_meter,
+    validate_intervals,
+    BaseSensor,
+)
 
 TextSensor = wmbus_meter_ns.class_(
     "TextSensor", BaseSensor, text_sensor.TextSensor)
 
-CONFIG_SCHEMA = BASE_SCHEMA.extend(text_sensor.text_sensor_schema(TextSensor))
+CONFIG_SCHEMA = cv.All(
+    BASE_SCHEMA.extend(text_sensor.text_sensor_schema(TextSensor)),
+    validate_intervals,
+)
 
 
 async def to_code(config):
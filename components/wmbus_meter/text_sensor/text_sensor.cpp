@@ -4,10 +4,17 @@ namespace esphome {
 namespace wmbus_meter {
 static const char *TAG = "wmbus_meter.text_sensor";
 
+TextSensor::TextSensor() { this->binding_.text = true; }
+
 void TextSensor::handle_update() {
-  auto val = this->parent_->get_string_field(this->field_name);
-  if (val.has_value())
-    this->publish_state(*val);
+  auto val = this->parent_->get_string_field(&this->binding_);
+  if (!val.has_value())
+    return;
+
+  if (!this->should_publish(*val != this->raw_state))
+    return;
+
+  this->publish_state(*val);
 }
 
 void TextSensor::dump_config() {
@@ -15,6 +22,9 @@ void TextSensor::dump_config() {
   ESP_LOGCONFIG(TAG, "  Parent meter ID: 0x%s",
                 this->parent_->get_id().c_str());
   ESP_LOGCONFIG(TAG, "  Field: '%s'", this->field_name.c_str());
+  if (this->is_failed())
+    ESP_LOGE(TAG, "  Field is not provided by the meter driver!");
+  this->dump_publish_config(TAG);
   LOG_TEXT_SENSOR("  ", "Name:", this);
 }
 } // namespace wmbus_meter
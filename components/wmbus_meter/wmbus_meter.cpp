@@ -1,16 +1,24 @@
 #include "wmbus_meter.h"
+#include "esphome/core/hal.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <esp_heap_caps.h>
 
 namespace esphome {
 namespace wmbus_meter {
 static const char *TAG = "wmbus_meter";
 
+static size_t free_heap() { return heap_caps_get_free_size(MALLOC_CAP_DEFAULT); }
+
 void Meter::set_meter_params(std::string id, std::string driver,
                              std::string key,
                              std::initializer_list<LinkMode> linkModes) {
-  MeterInfo meter_info;
-  meter_info.parse(driver + '-' + id, driver, id + ",", key);
+  this->meter_info_.parse(driver + '-' + id, driver, id + ",", key);
+  this->auto_driver_ = driver == "auto";
 
-  this->meter = createMeter(&meter_info);
+  this->create_meter(&this->meter_info_);
 
   for (auto linkMode : linkModes)
     this->link_modes_.addLinkMode(linkMode);
@@ -20,6 +28,59 @@ void Meter::set_radio(wmbus_radio::Radio *radio) {
   radio->add_frame_handler(
       [this](wmbus_radio::Frame *frame) { return this->handle_frame(frame); });
 }
+void Meter::set_persist_driver(bool persist_driver) {
+  this->persist_driver_ = persist_driver;
+}
+void Meter::set_persist_values(bool persist_values) {
+  this->persist_values_ = persist_values;
+}
+void Meter::set_persist_interval(uint32_t persist_interval) {
+  this->persist_interval_ = persist_interval;
+}
+void Meter::set_json_delta(uint32_t full_every) {
+  this->json_full_every_ = full_every;
+}
+
+struct PersistedDriver {
+  char name[32];
+};
+
+// The values are stored in a blob of fixed size, values that do not fit are
+// left out of the snapshot.
+struct PersistedValues {
+  uint32_t driver; // Hash of the driver name the snapshot was taken with.
+  uint16_t length;
+  uint8_t data[250];
+};
+
+void Meter::setup() {
+  if (this->persist_values_) {
+    this->values_pref_ = global_preferences->make_preference<PersistedValues>(
+        fnv1_hash("wmbus_meter_values_" + this->get_id()));
+    // Restored after all components are set up, so that boot is not delayed
+    // and the sensors are ready to publish.
+    this->defer([this]() { this->restore_values(); });
+  }
+
+  if (!this->auto_driver_ || !this->persist_driver_)
+    return;
+
+  this->driver_pref_ = global_preferences->make_preference<PersistedDriver>(
+      fnv1_hash("wmbus_meter_driver_" + this->get_id()));
+
+  PersistedDriver persisted;
+  if (!this->driver_pref_.load(&persisted))
+    return;
+
+  persisted.name[sizeof(persisted.name) - 1] = '\0';
+  auto driver_info = lookupDriver(persisted.name);
+  if (driver_info != nullptr) {
+    ESP_LOGD(TAG, "Restored driver %s for meter %s", persisted.name,
+             this->get_id().c_str());
+    this->use_driver(driver_info);
+  }
+}
+
 void Meter::dump_config() {
   std::string id = this->get_id();
   std::string driver = this->get_driver();
@@ -29,6 +90,25 @@ void Meter::dump_config() {
   ESP_LOGCONFIG(TAG, "  ID: 0x%s", id.c_str());
   ESP_LOGCONFIG(TAG, "  Driver: %s", driver.c_str());
   ESP_LOGCONFIG(TAG, "  Key: %s", key.c_str());
+  if (this->auto_driver_)
+    ESP_LOGCONFIG(TAG, "  Persist detected driver: %s",
+                  YESNO(this->persist_driver_));
+  if (this->persist_values_)
+    ESP_LOGCONFIG(TAG, "  Persist values: YES, at most every %" PRIu32 " s",
+                  this->persist_interval_ / 1000);
+  if (this->json_full_every_ > 0)
+    ESP_LOGCONFIG(TAG, "  JSON delta: full every %" PRIu32 " telegrams",
+                  this->json_full_every_);
+  ESP_LOGCONFIG(TAG, "  Heap: meter %" PRIu32 " bytes%s, values %" PRIi32
+                " bytes",
+                this->meter_heap_,
+                this->built_driver_fields_ ? " (with the driver fields)" : "",
+                this->values_heap_);
+  if (this->telegram_heap_peak_ > 0)
+    ESP_LOGCONFIG(TAG,
+                  "  Arena per telegram: last %" PRIu32 " bytes, peak %" PRIu32
+                  " bytes",
+                  this->telegram_heap_, this->telegram_heap_peak_);
 }
 
 std::string Meter::get_id() {
@@ -52,62 +132,352 @@ void Meter::handle_frame(wmbus_radio::Frame *frame) {
     return;
   }
 
+  // The header is only parsed here while the driver of an auto meter is to
+  // be detected, handleTelegram parses it again anyway.
+  TelegramArena *arena = this->radio->get_telegram_arena();
+  size_t arena_before = arena->used();
+  Telegram header(arena);
+  bool resolved = this->auto_driver_ && this->detect_driver_ &&
+                  this->resolve_driver(frame->data(), &header);
+  if (resolved)
+    this->detect_driver_ = false;
+
   auto about =
       AboutTelegram(App.get_friendly_name(), frame->rssi(), FrameType::WMBUS);
 
   std::vector<Address> adresses;
   bool id_match = false;
-  auto telegram = std::make_unique<Telegram>();
+  size_t heap_before = free_heap();
+  size_t overflow_before = arena->overflow();
+  auto telegram = std::make_unique<Telegram>(arena);
+
+  TelegramStage stage;
+  bool handled =
+      this->meter->handleTelegram(about, frame->data(), false, &adresses,
+                                  &id_match, telegram.get(), &stage);
+  // The arena is released by the radio after this handler, not with the
+  // telegram, leave the blocks it took from the heap out.
+  int32_t heap_used =
+      heap_before - free_heap() - (arena->overflow() - overflow_before);
+  if (id_match) {
+    // Nothing is freed from the arena before this handler is done, what the
+    // telegram took from it is the most it held while being parsed.
+    this->telegram_heap_ = arena->used() - arena_before;
+    this->telegram_heap_peak_ =
+        std::max(this->telegram_heap_peak_, this->telegram_heap_);
+  }
+
+  // A telegram that could not be decrypted or parsed says nothing about the
+  // driver, only one the driver found none of its fields in does.
+  if (this->auto_driver_ && stage == TelegramStage::CONTENT) {
+    ESP_LOGW(TAG, "Driver %s found no fields in telegram, detecting again",
+             this->get_driver().c_str());
+    if (resolved || header.parseHeader(frame->data()))
+      rejectPickedMeterDriver(&header, this->meter->driverInfo());
+    this->detect_driver_ = true;
+  }
 
-  this->meter->handleTelegram(about, frame->data(), false, &adresses, &id_match,
-                              telegram.get());
+  if (handled && this->persist_values_)
+    this->save_values();
 
   if (id_match) {
-    this->last_telegram = std::move(telegram);
-    this->defer([this]() {
-      this->on_telegram_callback_manager();
-      this->last_telegram = nullptr;
-    });
+    this->json_telegrams_++;
+    this->last_telegram_ = TelegramSummary(telegram.get());
+    this->last_telegram_->link_mode = frame->link_mode();
+
+    // What is not released with the telegram was added to the values.
+    size_t heap_before_release = free_heap();
+    telegram = nullptr;
+    int32_t released = free_heap() - heap_before_release;
+    this->values_heap_ += heap_used - released;
+
+    this->defer([this]() { this->on_telegram_callback_manager(); });
 
     frame->mark_as_handled();
   }
 }
 
+bool Meter::resolve_driver(std::vector<uint8_t> &data, Telegram *header) {
+  bool used_wildcard = false;
+  if (!header->parseHeader(data) || header->addresses.empty() ||
+      !doesTelegramMatchExpressions(header->addresses,
+                                    this->meter_info_.address_expressions,
+                                    &used_wildcard))
+    return false;
+
+  auto driver_info = pickMeterDriverCached(header);
+  if (driver_info == nullptr)
+    return false;
+
+  if (driver_info != this->meter->driverInfo()) {
+    ESP_LOGI(TAG, "Detected driver %s for meter %s",
+             driver_info->name().str().c_str(), this->get_id().c_str());
+    this->use_driver(driver_info);
+
+    if (this->persist_driver_) {
+      PersistedDriver persisted{};
+      strncpy(persisted.name, driver_info->name().str().c_str(),
+              sizeof(persisted.name) - 1);
+      this->driver_pref_.save(&persisted);
+    }
+  }
+
+  return true;
+}
+
+void Meter::use_driver(DriverInfo *driver_info) {
+  this->detect_driver_ = false;
+  MeterInfo meter_info = this->meter_info_;
+  meter_info.driver_name = driver_info->name();
+  this->create_meter(&meter_info);
+}
+
+void Meter::create_meter(MeterInfo *meter_info) {
+  DriverInfo *driver_info = lookupDriver(meter_info->driver_name.str());
+  bool builds_fields =
+      driver_info != nullptr && driver_info->fieldInfos() == nullptr;
+
+  size_t heap_before = free_heap();
+  auto meter = createMeter(meter_info);
+  if (!meter)
+    return;
+
+  // The old meter, if any, is released after measuring the new one.
+  this->meter_heap_ = std::max<int32_t>(heap_before - free_heap(), 0);
+  this->built_driver_fields_ = builds_fields;
+  this->values_heap_ = 0;
+  this->meter = meter;
+}
+
+void Meter::restore_values() {
+  // Values from a telegram received meanwhile are newer.
+  if (this->meter->numUpdates() > 0)
+    return;
+
+  uint32_t started = micros();
+  PersistedValues persisted;
+  if (!this->values_pref_.load(&persisted))
+    return;
+  if (persisted.driver != fnv1_hash(this->get_driver()) ||
+      persisted.length > sizeof(persisted.data)) {
+    ESP_LOGD(TAG, "Persisted values of meter %s are for another driver",
+             this->get_id().c_str());
+    return;
+  }
+
+  int restored = this->meter->restoreValues(persisted.data, persisted.length);
+  if (restored < 0) {
+    ESP_LOGW(TAG, "Persisted values of meter %s are invalid",
+             this->get_id().c_str());
+    return;
+  }
+  this->saved_snapshot_.assign(persisted.data,
+                               persisted.data + persisted.length);
+  ESP_LOGI(TAG, "Restored %d values of meter %s in %" PRIu32 " us", restored,
+           this->get_id().c_str(), micros() - started);
+  this->on_restore_callback_manager();
+}
+
+void Meter::save_values() {
+  if (this->save_pending_)
+    return;
+  uint32_t since = millis() - this->values_saved_at_.value_or(0);
+  if (this->values_saved_at_.has_value() && since < this->persist_interval_) {
+    this->save_pending_ = true;
+    this->set_timeout("save_values", this->persist_interval_ - since, [this]() {
+      this->save_pending_ = false;
+      this->save_values();
+    });
+    return;
+  }
+
+  PersistedValues persisted{};
+  this->snapshot_.clear();
+  this->meter->snapshotValues(&this->snapshot_, sizeof(persisted.data));
+  // The header changes with every telegram, only the values are compared.
+  if (this->snapshot_.size() == this->saved_snapshot_.size() &&
+      std::equal(this->snapshot_.begin() + SNAPSHOT_HEADER_SIZE,
+                 this->snapshot_.end(),
+                 this->saved_snapshot_.begin() + SNAPSHOT_HEADER_SIZE))
+    return;
+
+  // Only queued here, the preferences are written to flash on their sync.
+  persisted.driver = fnv1_hash(this->get_driver());
+  persisted.length = this->snapshot_.size();
+  std::memcpy(persisted.data, this->snapshot_.data(), this->snapshot_.size());
+  this->values_pref_.save(&persisted);
+  this->saved_snapshot_.swap(this->snapshot_);
+  this->values_saved_at_ = millis();
+}
+
 std::string Meter::as_json(bool pretty_print) {
   std::string json;
-  this->meter->printMeter(this->last_telegram.get(), nullptr, nullptr, '\t',
-                          &json, nullptr, nullptr, nullptr, pretty_print);
+  this->as_json(&json, pretty_print);
   return json;
 }
 
+void Meter::as_json(std::string *buffer, bool pretty_print) {
+  // The first telegram and every json_full_every_ telegram is a full json,
+  // the counter is stepped per telegram so that all consumers of the same
+  // telegram get the same kind of json. Restored values, before any
+  // telegram, are a full json too.
+  bool delta = this->json_full_every_ > 0 && this->json_telegrams_ > 0 &&
+               (this->json_telegrams_ - 1) % this->json_full_every_ != 0;
+  // Restored values have no telegram, they are written without media, id and
+  // rssi.
+  TelegramSummary none;
+  this->meter->writeJson(this->last_telegram_.has_value()
+                             ? &this->last_telegram_.value()
+                             : &none,
+                         buffer, nullptr, pretty_print, delta);
+}
+
 optional<std::string> Meter::get_string_field(std::string field_name) {
+  FieldBinding binding;
+  binding.field_name = field_name;
+  binding.text = true;
+  this->bind_field(&binding);
+  return this->get_string_field(&binding);
+}
 
-  if (field_name == "timestamp")
-    return this->meter->datetimeOfUpdateHumanReadable();
+optional<float> Meter::get_numeric_field(std::string field_name) {
+  FieldBinding binding;
+  binding.field_name = field_name;
+  this->bind_field(&binding);
+  return this->get_numeric_field(&binding);
+}
 
-  if (field_name == "timestamp_zulu")
-    return this->meter->datetimeOfUpdateRobot();
+// Field names like total_at_month_3 are generated from the telegram by a
+// field declared as total_at_month_{storage_counter}, these are looked up by
+// name when read.
+static bool is_field_name(::Meter *meter, const std::string &vname, Unit unit) {
+  for (auto &field_info : meter->fieldInfos()) {
+    auto &pattern = field_info.vname();
+    auto pos = pattern.find('{');
+    if (pos == std::string::npos) {
+      if (pattern == vname && field_info.displayUnit() == unit)
+        return true;
+    } else if (vname.compare(0, pos, pattern, 0, pos) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
 
-  auto field_info = this->meter->findFieldInfo(field_name, Quantity::Text);
-  if (field_info)
-    return this->meter->getStringValue(field_info);
+bool Meter::bind_field(FieldBinding *binding) {
+  binding->meter = this->meter.get();
+  binding->kind = FieldBinding::Kind::UNKNOWN;
+  binding->field_info = nullptr;
+  binding->scale = 1;
+  binding->offset = 0;
 
-  return {};
-}
+  auto &field_name = binding->field_name;
+  if (field_name == "timestamp") {
+    binding->kind = FieldBinding::Kind::TIMESTAMP;
+    return true;
+  }
+
+  if (binding->text) {
+    if (field_name == "timestamp_zulu") {
+      binding->kind = FieldBinding::Kind::TIMESTAMP_ZULU;
+      return true;
+    }
+    binding->vname = field_name;
+    binding->unit = Unit::TXT;
+    binding->field_info =
+        this->meter->findFieldInfo(field_name, Quantity::Text);
+    if (binding->field_info != nullptr)
+      binding->kind = FieldBinding::Kind::FIELD;
+    return binding->kind != FieldBinding::Kind::UNKNOWN;
+  }
 
-optional<float> Meter::get_numeric_field(std::string field_name) {
   // RSSI is not handled by meter but by telegram :/
-  if (field_name == "rssi_dbm")
-    return this->last_telegram->about.rssi_dbm;
+  if (field_name == "rssi_dbm") {
+    binding->kind = FieldBinding::Kind::RSSI;
+    return true;
+  }
 
-  if (field_name == "timestamp")
-    return this->meter->timestampLastUpdate();
+  // Diagnostics of the heap used by this meter.
+  if (field_name == "meter_heap_bytes") {
+    binding->kind = FieldBinding::Kind::METER_HEAP;
+    return true;
+  }
+  if (field_name == "telegram_heap_bytes") {
+    binding->kind = FieldBinding::Kind::TELEGRAM_HEAP;
+    return true;
+  }
+  if (field_name == "telegram_heap_peak_bytes") {
+    binding->kind = FieldBinding::Kind::TELEGRAM_HEAP_PEAK;
+    return true;
+  }
+
+  if (!extractUnit(field_name, &binding->vname, &binding->unit))
+    return false;
+
+  auto field_info =
+      this->meter->findFieldInfo(binding->vname, toQuantity(binding->unit));
+  if (field_info != nullptr &&
+      canConvert(field_info->displayUnit(), binding->unit)) {
+    binding->kind = FieldBinding::Kind::FIELD;
+    binding->field_info = field_info;
+    binding->offset = convert(0, field_info->displayUnit(), binding->unit);
+    binding->scale =
+        convert(1, field_info->displayUnit(), binding->unit) - binding->offset;
+  } else if (is_field_name(this->meter.get(), binding->vname, binding->unit)) {
+    binding->kind = FieldBinding::Kind::BY_NAME;
+  }
 
-  std::string name;
-  Unit unit;
-  extractUnit(field_name, &name, &unit);
+  return binding->kind != FieldBinding::Kind::UNKNOWN;
+}
+
+optional<std::string> Meter::get_string_field(FieldBinding *binding) {
+  if (binding->meter != this->meter.get() && !this->bind_field(binding))
+    ESP_LOGW(TAG, "Field '%s' is not provided by driver %s",
+             binding->field_name.c_str(), this->get_driver().c_str());
+
+  switch (binding->kind) {
+  case FieldBinding::Kind::TIMESTAMP:
+    return this->meter->datetimeOfUpdateHumanReadable();
+  case FieldBinding::Kind::TIMESTAMP_ZULU:
+    return this->meter->datetimeOfUpdateRobot();
+  case FieldBinding::Kind::FIELD:
+    return this->meter->getStringValue(binding->field_info);
+  default:
+    return {};
+  }
+}
+
+optional<float> Meter::get_numeric_field(FieldBinding *binding) {
+  if (binding->meter != this->meter.get() && !this->bind_field(binding))
+    ESP_LOGW(TAG, "Field '%s' is not provided by driver %s",
+             binding->field_name.c_str(), this->get_driver().c_str());
 
-  auto value = this->meter->getNumericValue(name, unit);
+  double value;
+  switch (binding->kind) {
+  case FieldBinding::Kind::RSSI:
+    // Not known for restored values.
+    if (!this->last_telegram_.has_value())
+      return {};
+    return this->last_telegram_->about.rssi_dbm;
+  case FieldBinding::Kind::TIMESTAMP:
+    return this->meter->timestampLastUpdate();
+  case FieldBinding::Kind::METER_HEAP:
+    return this->meter_heap_ + this->values_heap_;
+  case FieldBinding::Kind::TELEGRAM_HEAP:
+    return this->telegram_heap_;
+  case FieldBinding::Kind::TELEGRAM_HEAP_PEAK:
+    return this->telegram_heap_peak_;
+  case FieldBinding::Kind::FIELD:
+    value = this->meter->getNumericValue(
+        binding->field_info, binding->field_info->displayUnit());
+    value = value * binding->scale + binding->offset;
+    break;
+  case FieldBinding::Kind::BY_NAME:
+    value = this->meter->getNumericValue(binding->vname, binding->unit);
+    break;
+  default:
+    return {};
+  }
 
   if (!std::isnan(value))
     return value;
@@ -119,5 +489,9 @@ void Meter::on_telegram(std::function<void()> &&callback) {
   this->on_telegram_callback_manager.add(std::move(callback));
 }
 
+void Meter::on_restore(std::function<void()> &&callback) {
+  this->on_restore_callback_manager.add(std::move(callback));
+}
+
 } // namespace wmbus_meter
 } // namespace esphome
@@ -1,6 +1,7 @@
 #pragma once
 #include "esphome/core/component.h"
 #include "esphome/core/helpers.h"
+#include "esphome/core/preferences.h"
 
 #include "esphome/components/time/real_time_clock.h"
 
@@ -9,34 +10,132 @@
 
 namespace esphome {
 namespace wmbus_meter {
+// A sensor field name resolved against the fields of the meter driver, so
+// that reading it for every telegram needs no parsing or name lookup.
+struct FieldBinding {
+  enum class Kind {
+    UNKNOWN,
+    FIELD,
+    BY_NAME,
+    RSSI,
+    TIMESTAMP,
+    TIMESTAMP_ZULU,
+    METER_HEAP,
+    TELEGRAM_HEAP,
+    TELEGRAM_HEAP_PEAK
+  };
+
+  std::string field_name;
+  bool text = false;
+
+  Kind kind = Kind::UNKNOWN;
+  ::Meter *meter = nullptr; // The meter this binding was resolved against.
+  FieldInfo *field_info = nullptr;
+  std::string vname;
+  Unit unit = Unit::Unknown;
+  // Conversion from the display unit of the field to the requested unit.
+  double scale = 1;
+  double offset = 0;
+};
+
 class Meter : public Component {
 public:
   void set_meter_params(std::string id, std::string driver, std::string key,
                         std::initializer_list<LinkMode> linkModes);
   void set_radio(wmbus_radio::Radio *radio);
+  void set_persist_driver(bool persist_driver);
+  // Keep the last values in flash and publish them again after a reboot.
+  void set_persist_values(bool persist_values);
+  // Save changed values at most once per interval, in ms.
+  void set_persist_interval(uint32_t persist_interval);
+  // Render only changed values in as_json, with a full json every
+  // full_every telegram.
+  void set_json_delta(uint32_t full_every);
 
+  void setup() override;
   void dump_config() override;
   std::string get_id();
   std::string get_driver();
   std::string get_key();
+  bool is_auto_driver() { return this->auto_driver_; }
+
+  // Summary of the last telegram handled, not set for restored values.
+  const optional<TelegramSummary> &get_last_telegram() {
+    return this->last_telegram_;
+  }
 
   void on_telegram(std::function<void()> &&callback);
+  // Called when persisted values have been restored, there is no telegram.
+  void on_restore(std::function<void()> &&callback);
 
   std::string as_json(bool pretty_print = false);
+  // Append the json to a caller owned buffer, which can be reused between
+  // telegrams to avoid reallocations.
+  void as_json(std::string *buffer, bool pretty_print = false);
   optional<std::string> get_string_field(std::string field_name);
   optional<float> get_numeric_field(std::string field_name);
 
+  bool bind_field(FieldBinding *binding);
+  optional<std::string> get_string_field(FieldBinding *binding);
+  optional<float> get_numeric_field(FieldBinding *binding);
+
+  // Heap used by the meter, measured as the change of the free heap around
+  // the allocations, so other tasks allocating meanwhile add some noise.
+  // The meter instance, and the driver's field infos if this meter was the
+  // first one to use the driver.
+  uint32_t get_meter_heap() { return this->meter_heap_; }
+  // The stored values, which grow with the first telegrams.
+  int32_t get_values_heap() { return this->values_heap_; }
+  // Taken from the telegram arena of the radio to parse the telegram of the
+  // last update, the header too while the driver is detected. The arena is
+  // counted exactly, unlike the free heap it is not shared with other tasks.
+  // Short lived allocations outside of it, eg of the frame copies, are not
+  // included. The telegram is released before the callbacks run, only its
+  // summary is kept.
+  uint32_t get_telegram_heap() { return this->telegram_heap_; }
+  // The largest of those since boot.
+  uint32_t get_telegram_heap_peak() { return this->telegram_heap_peak_; }
+
 protected:
   LinkModeSet link_modes_;
+  MeterInfo meter_info_;
+  bool auto_driver_ = false;
+  bool persist_driver_ = false;
+  // Set until a driver is picked for an auto meter, and again when the
+  // picked driver fails to parse a telegram.
+  bool detect_driver_ = true;
+  bool persist_values_ = false;
+  uint32_t persist_interval_ = 0;
+  // When the values were last saved, a later change is saved once the
+  // persist interval has passed.
+  optional<uint32_t> values_saved_at_;
+  bool save_pending_ = false;
+  uint32_t json_full_every_ = 0; // Zero when the delta json is not used.
+  uint32_t json_telegrams_ = 0;
+  ESPPreferenceObject driver_pref_;
+  ESPPreferenceObject values_pref_;
+  std::vector<uchar> snapshot_;
+  std::vector<uchar> saved_snapshot_;
   time::RealTimeClock *rtc;
   wmbus_radio::Radio *radio;
 
   std::shared_ptr<::Meter> meter;
-  std::unique_ptr<Telegram> last_telegram;
+  uint32_t meter_heap_ = 0;
+  bool built_driver_fields_ = false;
+  int32_t values_heap_ = 0;
+  uint32_t telegram_heap_ = 0;
+  uint32_t telegram_heap_peak_ = 0;
+  optional<TelegramSummary> last_telegram_;
 
   CallbackManager<void()> on_telegram_callback_manager;
+  CallbackManager<void()> on_restore_callback_manager;
 
   void handle_frame(wmbus_radio::Frame *frame);
+  bool resolve_driver(std::vector<uint8_t> &data, Telegram *header);
+  void use_driver(DriverInfo *driver_info);
+  void create_meter(MeterInfo *meter_info);
+  void restore_values();
+  void save_values();
 };
 } // namespace wmbus_meter
 } // namespace esphome
\ No newline at end of file
@@ -172,6 +172,7 @@ with suppress(ImportError):
                 "hex",
                 "raw",
                 "rtlwmbus",
+                "binary",
                 lower=True,
             ),
             cv.Optional(CONF_DATA): cv.invalid(
@@ -190,6 +191,7 @@ with suppress(ImportError):
             "hex": cg.std_string,
             "raw": cg.std_vector.template(cg.uint8),
             "rtlwmbus": cg.std_string,
+            "binary": cg.std_vector.template(cg.uint8),
         }[config[CONF_FORMAT]]
 
         paren = await cg.get_variable(config[CONF_ID])
@@ -69,14 +69,18 @@ void Radio::loop() {
            frame->format().c_str());
 
   uint8_t packet_handled = 0;
-  for (auto &handler : this->handlers_)
+  // The telegrams a handler parses are gone when it returns, so the arena is
+  // released after each one and never holds more than one meter's parse.
+  for (auto &handler : this->handlers_) {
     handler(&frame.value());
+    this->telegram_arena_.release();
+  }
 
   if (frame->handlers_count())
     ESP_LOGI(TAG, "Telegram handled by %d handlers", frame->handlers_count());
   else {
     ESP_LOGW(TAG, "Telegram not handled by any handler");
-    Telegram t;
+    Telegram t(&this->telegram_arena_);
     if (t.parseHeader(frame->data()) && t.addresses.empty()) {
       ESP_LOGW(TAG, "Check if telegram can be parsed on:");
     } else {
@@ -87,6 +91,7 @@ void Radio::loop() {
              (std::string{"https://wmbusmeters.org/analyze/"} + frame->as_hex())
                  .c_str());
   }
+  this->telegram_arena_.release();
 }
 
 void Radio::wakeup_receiver_task_from_isr(TaskHandle_t *arg) {
@@ -27,6 +27,9 @@ public:
   void wakeup_polling_receiver_task();
 
   void add_frame_handler(std::function<void(Frame *)> &&callback);
+  // Shared by the telegrams the handlers parse from a frame, it is released
+  // after each handler.
+  TelegramArena *get_telegram_arena() { return &this->telegram_arena_; }
 
 protected:
   static void wakeup_receiver_task_from_isr(TaskHandle_t *arg);
@@ -37,6 +40,7 @@ protected:
   QueueHandle_t packet_queue_;
 
   std::vector<std::function<void(Frame *)>> handlers_;
+  TelegramArena telegram_arena_;
 };
 } // namespace wmbus_radio
 } // namespace esphome
@@ -1,6 +1,8 @@
 #include "packet.h"
 
+#include <cstring>
 #include <ctime>
+#include <sys/time.h>
 
 #include "esphome/components/wmbus_common/meters.h"
 #include "esphome/core/helpers.h"
@@ -155,7 +157,31 @@ std::optional<Frame> Packet::convert_to_frame() {
 
 Frame::Frame(Packet *packet)
     : data_(std::move(packet->data_)), link_mode_(packet->link_mode_),
-      rssi_(packet->rssi_), format_(packet->frame_format_) {}
+      rssi_(packet->rssi_), format_(packet->frame_format_) {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  this->timestamp_us_ = (uint64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+std::optional<Frame> Frame::from_binary(const uint8_t *record, size_t length) {
+  if (length < BINARY_HEADER_SIZE || record[0] != BINARY_FORMAT_VERSION)
+    return {};
+  size_t data_length = record[6] | record[7] << 8;
+  if (BINARY_HEADER_SIZE + data_length != length ||
+      record[1] > (uint8_t)LinkMode::UNKNOWN)
+    return {};
+
+  Frame frame;
+  frame.link_mode_ = (LinkMode)record[1];
+  if (record[2] != 0)
+    frame.format_ = std::string(1, (char)record[2]);
+  frame.rssi_ = (int8_t)record[3];
+  frame.timestamp_us_ = 0;
+  for (int i = 0; i < 8; i++)
+    frame.timestamp_us_ |= (uint64_t)record[8 + i] << (8 * i);
+  frame.data_.assign(record + BINARY_HEADER_SIZE, record + length);
+  return frame;
+}
 
 std::vector<uint8_t> &Frame::data() { return this->data_; }
 LinkMode Frame::link_mode() { return this->link_mode_; }
@@ -167,7 +193,8 @@ std::string Frame::as_hex() { return format_hex(this->data_); }
 std::string Frame::as_rtlwmbus() {
   const size_t time_repr_size = sizeof("YYYY-MM-DD HH:MM:SS.00Z");
   char time_buffer[time_repr_size];
-  auto t = std::time(NULL);
+  // Frames restored from a binary record keep their receive time.
+  time_t t = this->timestamp_us_ / 1000000;
   std::strftime(time_buffer, time_repr_size, "%F %T.00Z", std::gmtime(&t));
 
   auto output = std::string{};
@@ -185,6 +212,33 @@ std::string Frame::as_rtlwmbus() {
   return output;
 }
 
+std::vector<uint8_t> Frame::as_binary(uint8_t radio_id) {
+  auto output = std::vector<uint8_t>{};
+  output.reserve(BINARY_HEADER_SIZE + this->data_.size());
+  this->append_binary(output, radio_id);
+  return output;
+}
+
+void Frame::append_binary(std::vector<uint8_t> &out, uint8_t radio_id) {
+  auto length = (uint16_t)this->data_.size();
+  auto offset = out.size();
+  out.resize(offset + BINARY_HEADER_SIZE + length);
+
+  auto header = out.data() + offset;
+  header[0] = BINARY_FORMAT_VERSION;
+  header[1] = (uint8_t)this->link_mode_;
+  header[2] = this->format_.empty() ? 0 : this->format_[0];
+  header[3] = (uint8_t)this->rssi_;
+  header[4] = radio_id;
+  header[5] = 0;
+  header[6] = length & 0xff;
+  header[7] = length >> 8;
+  for (int i = 0; i < 8; i++)
+    header[8 + i] = (this->timestamp_us_ >> (8 * i)) & 0xff;
+
+  std::memcpy(header + BINARY_HEADER_SIZE, this->data_.data(), length);
+}
+
 void Frame::mark_as_handled() { this->handlers_count_++; }
 uint8_t Frame::handlers_count() { return this->handlers_count_; }
 
@@ -13,6 +13,19 @@ namespace esphome {
 namespace wmbus_radio {
 struct Frame;
 
+// Binary frame record, all numbers little endian:
+//   0  u8   version, BINARY_FORMAT_VERSION
+//   1  u8   link mode, index in LIST_OF_LINK_MODES (T1 = 5, C1 = 7)
+//   2  u8   frame format, 'A', 'B' or 0 if unknown
+//   3  i8   rssi in dBm
+//   4  u8   radio id, chosen by the caller
+//   5  u8   reserved, 0
+//   6  u16  length of the frame data
+//   8  u64  receive time in microseconds since the epoch
+//  16       frame data without DLL CRCs
+static const uint8_t BINARY_FORMAT_VERSION = 1;
+static const size_t BINARY_HEADER_SIZE = 16;
+
 struct Packet {
   friend class Frame;
 
@@ -48,6 +61,9 @@ protected:
 struct Frame {
 public:
   Frame(Packet *packet);
+  // Restore a frame from a record written by as_binary().
+  static std::optional<Frame> from_binary(const uint8_t *record,
+                                          size_t length);
 
   std::vector<uint8_t> &data();
   LinkMode link_mode();
@@ -57,15 +73,20 @@ public:
   std::vector<uint8_t> as_raw();
   std::string as_hex();
   std::string as_rtlwmbus();
+  std::vector<uint8_t> as_binary(uint8_t radio_id = 0);
+  void append_binary(std::vector<uint8_t> &out, uint8_t radio_id = 0);
 
   void mark_as_handled();
   uint8_t handlers_count();
 
 protected:
+  Frame() = default;
+
   std::vector<uint8_t> data_;
   LinkMode link_mode_;
   int8_t rssi_;
   std::string format_;
+  uint64_t timestamp_us_;
   uint8_t handlers_count_ = 0;
 };
 
@@ -0,0 +1,121 @@
+#!/usr/bin/env python3
+"""Convert binary frame records from wmbus_radio to rtl_wmbus text lines.
+
+The records are produced by Frame::as_binary(), for example with:
+
+    - wmbus_radio.send_frame_with_socket:
+        id: my_socket
+        format: binary
+
+Usage:
+    binary_to_rtlwmbus.py [FILE]        read a record stream, default stdin
+    binary_to_rtlwmbus.py --tcp PORT    accept a socket_transmitter over TCP
+    binary_to_rtlwmbus.py --udp PORT    receive datagrams, one record each
+    binary_to_rtlwmbus.py --udp PORT --batched
+                                        receive datagrams from a
+                                        socket_transmitter with 'batch:'
+
+The lines are written to stdout and can be fed to wmbusmeters using
+'wmbusmeters stdin:rtlwmbus'.
+"""
+
+import argparse
+import datetime
+import socket
+import struct
+import sys
+
+HEADER = struct.Struct("<BBBbBBHQ")
+VERSION = 1
+
+# Order of LIST_OF_LINK_MODES in wmbus_common/wmbus.h.
+LINK_MODES = [
+    "Any", "MBUS", "S1", "S1m", "S2", "T1", "T2", "C1", "C2",
+    "N1a", "N2a", "N1b", "N2b", "N1c", "N2c", "N1d", "N2d", "N1e", "N2e",
+    "N1f", "N2f", "R2a", "R2b", "R2c", "R2d", "R2e", "R2f", "R2g", "R2h",
+    "R2i", "R2j", "LORA", "UNKNOWN",
+]
+
+
+def to_rtlwmbus(header, data):
+    _, link_mode, _, rssi, _, _, _, timestamp_us = header
+    name = LINK_MODES[link_mode] if link_mode < len(LINK_MODES) else "UNKNOWN"
+    t = datetime.datetime.fromtimestamp(timestamp_us / 1e6, datetime.timezone.utc)
+    when = t.strftime("%Y-%m-%d %H:%M:%S.") + "%02dZ" % (t.microsecond // 10000)
+    return f"{name};1;1;{when};{rssi};;;0x{data.hex()}\n"
+
+
+def decode_records(buffer):
+    """Decode the complete records in buffer, return the lines and the rest."""
+    lines = []
+    view = memoryview(buffer)
+    offset = 0
+    while len(view) - offset >= HEADER.size:
+        header = HEADER.unpack_from(view, offset)
+        if header[0] != VERSION:
+            raise ValueError(f"unsupported record version {header[0]}")
+        end = offset + HEADER.size + header[6]
+        if end > len(view):
+            break
+        lines.append(to_rtlwmbus(header, bytes(view[offset + HEADER.size:end])))
+        offset = end
+    return lines, bytes(view[offset:])
+
+
+def decode_batch(datagram):
+    """Decode a batch of records, each prefixed by its length big endian."""
+    lines = []
+    offset = 0
+    while offset + 2 <= len(datagram):
+        (length,) = struct.unpack_from(">H", datagram, offset)
+        lines += decode_records(datagram[offset + 2:offset + 2 + length])[0]
+        offset += 2 + length
+    return lines
+
+
+def copy_stream(read, out):
+    rest = b""
+    while chunk := read(65536):
+        lines, rest = decode_records(rest + chunk)
+        out.writelines(lines)
+        out.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("file", nargs="?", help="record stream, default stdin")
+    parser.add_argument("--tcp", type=int, metavar="PORT")
+    parser.add_argument("--udp", type=int, metavar="PORT")
+    parser.add_argument("--batched", action="store_true",
+                        help="udp datagrams are batches of records")
+    args = parser.parse_args()
+    out = sys.stdout
+
+    if args.udp:
+        sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        sock.bind(("", args.udp))
+        while True:
+            datagram = sock.recv(65536)
+            if args.batched:
+                out.writelines(decode_batch(datagram))
+            else:
+                out.writelines(decode_records(datagram)[0])
+            out.flush()
+    elif args.tcp:
+        server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        server.bind(("", args.tcp))
+        server.listen(1)
+        while True:
+            conn, _ = server.accept()
+            with conn:
+                copy_stream(conn.recv, out)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            copy_stream(f.read, out)
+    else:
+        copy_stream(sys.stdin.buffer.read1, out)
+
+
+if __name__ == "__main__":
+    main()